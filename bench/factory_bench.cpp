@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace cvs::logger;
+
+namespace {
+
+constexpr int logger_count = 1000;
+constexpr int group_count  = 40;
+
+std::string loggerName(int i) {
+  return "bench.group" + std::to_string(i % group_count) + ".logger" + std::to_string(i);
+}
+
+// 1k loggers and 100 rules: 40 literal names, 40 prefixes and 20 true regular expressions.
+void prepareFactory() {
+  static const bool prepared = [] {
+    for (int i = 0; i < 40; ++i)
+      LoggerFactory::configure(loggerName(i * 7), std::tuple{Level::debug, Sinks::NOSINK});
+    for (int i = 0; i < group_count; ++i)
+      LoggerFactory::configure(Regex{"bench\\.group" + std::to_string(i) + "\\..*"},
+                               std::tuple{Level::info, Sinks::NOSINK});
+    for (int i = 0; i < 20; ++i)
+      LoggerFactory::configure(
+          Regex{"bench\\.group[0-9]+\\.logger" + std::to_string(i) + "[0-9]"},
+          std::tuple{Level::warn});
+
+    for (int i = 0; i < logger_count; ++i)
+      LoggerFactory::getLogger(loggerName(i));
+    return true;
+  }();
+  benchmark::DoNotOptimize(prepared);
+}
+
+void BM_Configure(benchmark::State& state) {
+  prepareFactory();
+  for (auto _ : state)
+    LoggerFactory::configure();
+}
+BENCHMARK(BM_Configure)->Unit(benchmark::kMillisecond);
+
+// Changes the level of one logger back and forth.
+void BM_ConfigureOne(benchmark::State& state) {
+  prepareFactory();
+  auto name = loggerName(7);
+
+  bool debug = false;
+  for (auto _ : state)
+    LoggerFactory::configure(name, std::tuple{(debug = !debug) ? Level::debug : Level::info});
+}
+BENCHMARK(BM_ConfigureOne)->Unit(benchmark::kMicrosecond);
+
+// Changes a prefix rule matching 25 loggers and a literal name in one batch.
+void BM_ConfigureBatch(benchmark::State& state) {
+  prepareFactory();
+  auto name = loggerName(14);
+
+  bool debug = false;
+  for (auto _ : state) {
+    auto level = (debug = !debug) ? Level::debug : Level::info;
+    LoggerFactory::configure(
+        Config().set(Regex{"bench\\.group3\\..*"}, level).set(name, level, Pattern{"%v"}));
+  }
+}
+BENCHMARK(BM_ConfigureBatch)->Unit(benchmark::kMicrosecond);
+
+void BM_GetLoggerHit(benchmark::State& state) {
+  prepareFactory();
+
+  std::vector<std::string> names;
+  for (int i = 0; i < 64; ++i)
+    names.push_back(loggerName(state.thread_index() * 64 + i));
+
+  std::size_t i = 0;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(LoggerFactory::getLogger(names[++i % names.size()]));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetLoggerHit)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_GetLoggerMiss(benchmark::State& state) {
+  prepareFactory();
+  static int i = logger_count;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(LoggerFactory::getLogger(loggerName(i++)));
+}
+BENCHMARK(BM_GetLoggerMiss)->Iterations(2000);
+
+}  // namespace
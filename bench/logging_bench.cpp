@@ -0,0 +1,139 @@
+#include <benchmark/benchmark.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <string>
+#include <tuple>
+
+using namespace cvs::logger;
+
+namespace {
+
+void BM_DisabledLog(benchmark::State& state) {
+  LoggerFactory::configure("bench.disabled", std::tuple{Level::info, Sinks::NOSINK});
+  auto logger = LoggerFactory::getLogger("bench.disabled");
+
+  int i = 0;
+  for (auto _ : state) {
+    LOG_TRACE(logger, "Frame {}", ++i);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DisabledLog)->ThreadRange(1, 4)->UseRealTime();
+
+void BM_DisabledNamedLog(benchmark::State& state) {
+  LoggerFactory::configure("bench.disabled", std::tuple{Level::info, Sinks::NOSINK});
+
+  int i = 0;
+  for (auto _ : state) {
+    LOG_NAMED_TRACE("bench.disabled", "Frame {}", ++i);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DisabledNamedLog)->ThreadRange(1, 4)->UseRealTime();
+
+void BM_DisabledGlobLog(benchmark::State& state) {
+  LoggerFactory::configure(LoggerFactory::default_logger_name, std::tuple{Level::info});
+
+  int i = 0;
+  for (auto _ : state) {
+    LOG_GLOB_TRACE("Frame {}", ++i);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DisabledGlobLog)->ThreadRange(1, 4)->UseRealTime();
+
+// Messages below the logger level captured by the flight recorder.
+void BM_RecorderCapture(benchmark::State& state) {
+  LoggerFactory::configure("bench.recorder",
+                           std::tuple{Level::info, Sinks::NOSINK, Recorder{Level::trace, 4096}});
+  auto logger = LoggerFactory::getLogger("bench.recorder");
+
+  int i = 0;
+  for (auto _ : state) {
+    LOG_TRACE(logger, "Frame {} took {:.3f} ms on camera {}", ++i, 1.5, "front");
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_RecorderCapture)->ThreadRange(1, 4)->UseRealTime();
+
+}  // namespace
+
+namespace {
+
+// Enabled logging without sinks, so only argument processing and formatting are measured.
+LoggerPtr formatLogger() {
+  LoggerFactory::configure("bench.format", std::tuple{Level::trace, Sinks::NOSINK});
+  return LoggerFactory::getLogger("bench.format");
+}
+
+void BM_FormatRuntime(benchmark::State& state) {
+  auto        logger = formatLogger();
+  std::string format = "Frame {} took {:.3f} ms on camera {}";
+
+  int i = 0;
+  for (auto _ : state)
+    LOG_INFO(logger, format, ++i, 16.6, "front");
+}
+BENCHMARK(BM_FormatRuntime);
+
+void BM_FormatChecked(benchmark::State& state) {
+  auto logger = formatLogger();
+
+  int i = 0;
+  for (auto _ : state)
+    LOG_INFO(logger, "Frame {} took {:.3f} ms on camera {}", ++i, 16.6, "front");
+}
+BENCHMARK(BM_FormatChecked)->ThreadRange(1, 4)->UseRealTime();
+
+void BM_FormatCompiled(benchmark::State& state) {
+  auto logger = formatLogger();
+
+  int i = 0;
+  for (auto _ : state)
+    LOG_INFO(logger, FMT_COMPILE("Frame {} took {:.3f} ms on camera {}"), ++i, 16.6, "front");
+}
+BENCHMARK(BM_FormatCompiled);
+
+// Caller side of the deferred backend, the backend thread formats the messages without sinks.
+void BM_FormatDeferred(benchmark::State& state) {
+  LoggerFactory::configure("bench.deferred",
+                           std::tuple{Level::trace, Sinks::NOSINK, Backend::deferred});
+  auto logger  = LoggerFactory::getLogger("bench.deferred");
+  auto dropped = deferred::dropped();
+
+  int i = 0;
+  for (auto _ : state)
+    LOG_INFO(logger, "Frame {} took {:.3f} ms on camera {}", ++i, 16.6, "front");
+
+  deferred::flush();
+  state.counters["dropped"] = double(deferred::dropped() - dropped);
+}
+BENCHMARK(BM_FormatDeferred);
+
+}  // namespace
+
+namespace {
+
+// Cost of a call skipped by the rate limit, compare with BM_FormatChecked.
+void BM_EveryNSkipped(benchmark::State& state) {
+  auto logger = formatLogger();
+
+  int i = 0;
+  for (auto _ : state)
+    LOG_INFO_EVERY_N(logger, 1000000000, "Frame {} took {:.3f} ms on camera {}", ++i, 16.6,
+                     "front");
+}
+BENCHMARK(BM_EveryNSkipped)->ThreadRange(1, 4)->UseRealTime();
+
+void BM_EverySkipped(benchmark::State& state) {
+  auto logger = formatLogger();
+
+  int i = 0;
+  for (auto _ : state)
+    LOG_INFO_EVERY(logger, std::chrono::hours(1), "Frame {} took {:.3f} ms on camera {}", ++i, 16.6,
+                   "front");
+}
+BENCHMARK(BM_EverySkipped)->ThreadRange(1, 4)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <tuple>
+
+using namespace cvs::logger;
+
+namespace {
+
+// Caller cost of a cv::Mat argument for a square 8UC3 image of range(0) pixels per side. With
+// LogImage::enable the image is copied to the PNG writer pool, with LogImage::raw into the ring.
+void logImages(benchmark::State& state, const std::string& name, LogImage mode) {
+  LoggerFactory::configure(name, std::tuple{Level::trace, Sinks::NOSINK, mode});
+  auto logger = LoggerFactory::getLogger(name);
+
+  int     side = int(state.range(0));
+  cv::Mat mat(side, side, CV_8UC3, cv::Scalar(0, 128, 255));
+  for (auto _ : state)
+    LOG_INFO(logger, "Frame {}", mat);
+  flushImages();
+
+  state.SetBytesProcessed(state.iterations() * std::int64_t(mat.total() * mat.elemSize()));
+}
+
+void BM_ImageDisabled(benchmark::State& state) {
+  logImages(state, "bench.image.disabled", LogImage::disable);
+}
+BENCHMARK(BM_ImageDisabled)->Arg(64)->Arg(1024)->ThreadRange(1, 4)->UseRealTime();
+
+void BM_ImagePng(benchmark::State& state) {
+  logImages(state, "bench.image.png", LogImage::enable);
+}
+BENCHMARK(BM_ImagePng)->Arg(64)->Arg(1024)->ThreadRange(1, 4)->UseRealTime();
+
+void BM_ImageRaw(benchmark::State& state) {
+  logImages(state, "bench.image.raw", LogImage::raw);
+}
+BENCHMARK(BM_ImageRaw)->Arg(64)->Arg(1024)->ThreadRange(1, 4)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <filesystem>
+#include <string>
+#include <tuple>
+
+using namespace cvs::logger;
+
+namespace {
+
+// Throughput of one sink with the default pattern. Run with stdout redirected to a file or
+// /dev/null to compare against the terminal-independent cost of the stdout sink.
+void logMessages(benchmark::State& state, const LoggerPtr& logger) {
+  int i = 0;
+  for (auto _ : state)
+    LOG_INFO(logger, "Frame {} took {:.3f} ms on camera {}", ++i, 16.6, "front");
+  // Error messages flush the file sinks, see LogFile::flush_level.
+  LOG_ERROR(logger, "Done");
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_StdoutSink(benchmark::State& state) {
+  LoggerFactory::configure("bench.sink.stdout", std::tuple{Level::trace, Sinks::STDOUT});
+  logMessages(state, LoggerFactory::getLogger("bench.sink.stdout"));
+}
+BENCHMARK(BM_StdoutSink);
+
+void BM_FileSink(benchmark::State& state) {
+  auto    dir = std::filesystem::temp_directory_path() / "cvslogger_bench";
+  LogFile options{std::size_t(256) << 20, {}, std::size_t(state.range(0)), Level::err, false};
+  LoggerFactory::configure("bench.sink.file", std::tuple{Level::trace, Sinks::FILE, dir, options});
+  logMessages(state, LoggerFactory::getLogger("bench.sink.file"));
+}
+BENCHMARK(BM_FileSink)->Arg(4 << 10)->Arg(1 << 20);
+
+void BM_FileSinkMmap(benchmark::State& state) {
+  auto    dir = std::filesystem::temp_directory_path() / "cvslogger_bench";
+  LogFile options{std::size_t(256) << 20, {}, std::size_t(4) << 20, Level::err, true};
+  LoggerFactory::configure("bench.sink.mmap", std::tuple{Level::trace, Sinks::FILE, dir, options});
+  logMessages(state, LoggerFactory::getLogger("bench.sink.mmap"));
+}
+BENCHMARK(BM_FileSinkMmap);
+
+}  // namespace
@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include <cvs/logger/logging.hpp>
+#include <cvs/logger/tools/fpslogger.hpp>
+#include <cvs/logger/tools/stagetracker.hpp>
+
+#include <tuple>
+
+using namespace cvs::logger;
+
+namespace {
+
+// Per-frame reports are trace and debug messages, so only the bookkeeping is measured.
+tools::FpsLogger& fpsLogger() {
+  LoggerFactory::configure("bench.fps", std::tuple{Level::info, Sinks::NOSINK});
+
+  static tools::FpsLogger fps_logger("bench.fps");
+  fps_logger.start();
+  return fps_logger;
+}
+
+// Several producers of one FpsLogger.
+void BM_FpsNewFrame(benchmark::State& state) {
+  static tools::FpsLogger* fps_logger = nullptr;
+  if (state.thread_index() == 0)
+    fps_logger = &fpsLogger();
+
+  for (auto _ : state)
+    fps_logger->newFrame();
+}
+BENCHMARK(BM_FpsNewFrame)->ThreadRange(1, 4)->UseRealTime();
+
+// Two nested scoped timers per iteration, so four clock reads and two records.
+void BM_StageTimer(benchmark::State& state) {
+  static tools::StageTracker* tracker = nullptr;
+  if (state.thread_index() == 0) {
+    LoggerFactory::configure("bench.stages", std::tuple{Level::info, Sinks::NOSINK});
+    static tools::StageTracker stage_tracker("bench.stages");
+    tracker = &stage_tracker;
+  }
+
+  for (auto _ : state) {
+    STAGE_TIMER(*tracker, "frame");
+    STAGE_TIMER(*tracker, "detect");
+  }
+}
+BENCHMARK(BM_StageTimer)->ThreadRange(1, 4)->UseRealTime();
+
+}  // namespace
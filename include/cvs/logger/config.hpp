@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cvs/logger/configtypes.hpp>
+#include <cvs/logger/cvslogger_export.hpp>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace cvs::logger {
+
+/**
+ * Batch of configuration changes, applied by LoggerFactory::configure(const Config&) under one lock
+ * to the loggers matched by the changed rules only.
+ *
+ * A batch can be loaded from a file with sections of `key = value` lines. A section applies to the
+ * logger `[name]` or to the loggers matching `[regex <expression>]`, `[]` is the default logger:
+ *
+ *     [camera]
+ *     level   = debug
+ *     sinks   = stdout | file
+ *     pattern = "[%T.%e] %n: %v"
+ *     time    = utc
+ *     file.max_size = 64M
+ *     async.threads = 1
+ *     dedup.timeout = 500ms
+ *
+ * The keys are the option types: `level`, `pattern` with `time`, `path`, `sinks`, `log_image`,
+ * `image_ring`, `backend`, and the fields of LogFile, Async, Dedup and Recorder as `file.*`,
+ * `async.*`, `dedup.*` and `recorder.*`. Omitted fields keep their defaults. Sizes take K, M and G
+ * suffixes, durations ms, s, min and h. Lines starting with `#` are comments.
+ */
+class CVSLOGGER_EXPORT Config {
+ public:
+  // Owning copy of a Pattern.
+  struct PatternOption {
+    std::string text;
+    TimeType    time_type = TimeType::local;
+
+    bool operator==(const PatternOption&) const = default;
+  };
+
+  using Option = std::variant<Level,
+                              PatternOption,
+                              std::filesystem::path,
+                              Sinks,
+                              LogImage,
+                              Async,
+                              ImageRing,
+                              Backend,
+                              LogFile,
+                              Dedup,
+                              Recorder>;
+
+  struct Rule {
+    std::string         name;  // A logger name or a regular expression.
+    bool                regex = false;
+    std::vector<Option> options;
+  };
+
+  // Throws std::invalid_argument with the line of the first error.
+  static Config parse(std::string_view text, std::string_view source = "config");
+  // Throws std::system_error if the file can't be read.
+  static Config load(const std::filesystem::path& file);
+
+  template <typename... Args>
+  Config& set(std::string_view name, Args... options) {
+    rule_list.push_back(Rule{std::string(name), false, {option(std::move(options))...}});
+    return *this;
+  }
+  template <typename... Args>
+  Config& set(Regex regex, Args... options) {
+    rule_list.push_back(Rule{std::string(regex), true, {option(std::move(options))...}});
+    return *this;
+  }
+
+  Config& add(Rule rule) {
+    rule_list.push_back(std::move(rule));
+    return *this;
+  }
+
+  const std::vector<Rule>& rules() const { return rule_list; }
+  bool                     empty() const { return rule_list.empty(); }
+
+ private:
+  static Option option(Pattern p) { return PatternOption{std::string(p), p.time_type}; }
+  template <typename T>
+  static Option option(T value) {
+    return Option(std::in_place_type<T>, std::move(value));
+  }
+
+  std::vector<Rule> rule_list;
+};
+
+}  // namespace cvs::logger
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -11,6 +13,7 @@ enum class Sinks : int {
   NOSINK  = 0,
   STDOUT  = 1,
   SYSTEMD = 2,
+  FILE    = 4,
 };
 
 constexpr bool  operator&(Sinks s0, Sinks s1) { return (int(s0) & int(s1)) != 0; }
@@ -28,7 +31,96 @@ enum class Level {
 
 enum class TimeType { local = 0, utc };
 
-enum class LogImage { disable = 0, enable };
+/**
+ * `enable` encodes logged images to PNG files. `raw` copies them into a memory-mapped ring file
+ * under the logger path, see ImageRing.
+ */
+enum class LogImage { disable = 0, enable, raw };
+
+/**
+ * `deferred` copies the literal format and the arguments into a ring of the calling thread, and a
+ * backend thread formats them to the sinks. `binary` writes them unformatted to
+ * `<path>/cvslogger-<pid>.clog` instead, see cvslogger_decode. Calls with arguments that can't be
+ * packed (not arithmetic or strings) and runtime formats are still formatted on the caller's
+ * thread.
+ */
+enum class Backend { spdlog = 0, deferred, binary };
+
+// Size of the ring file used by LogImage::raw.
+struct CVSLOGGER_EXPORT ImageRing {
+  std::size_t bytes = std::size_t(256) << 20;
+
+  bool operator==(const ImageRing&) const = default;
+};
+
+/**
+ * Options of Sinks::FILE. A logger writes to `<path>/<name>.log`. The segment is rotated to
+ * `<name>.<start time>.log` when it would grow over `max_size` bytes or is older than `max_age`,
+ * zero disables either limit. Messages are collected in a `buffer_size` buffer and written when it
+ * is full, on flush, on messages of `flush_level` and higher and at the latest `flush_interval`
+ * after the oldest buffered message, zero disables the interval. With `mmap` the file is extended
+ * by `buffer_size` chunks and written through a mapping instead, so the kernel writes the data
+ * even if the process crashes.
+ *
+ * Rotated segments are gzip-compressed by a low-priority background thread when `compress` is set
+ * and the library is built with zlib. The oldest segments are removed once all rotated segments of
+ * the logger take more than `retention` bytes, zero keeps them all. See cvslogger_zgrep.
+ */
+struct CVSLOGGER_EXPORT LogFile {
+  std::size_t               max_size       = std::size_t(64) << 20;
+  std::chrono::seconds      max_age        = std::chrono::seconds(0);
+  std::size_t               buffer_size    = std::size_t(1) << 20;
+  Level                     flush_level    = Level::warn;
+  bool                      mmap           = false;
+  bool                      compress       = false;
+  std::size_t               retention      = 0;
+  std::chrono::milliseconds flush_interval = std::chrono::seconds(1);
+
+  bool operator==(const LogFile&) const = default;
+};
+
+/**
+ * Collapses identical consecutive messages of a logger with the same level. The first message is
+ * written and its repeats are counted. The count is written as "last message repeated N times" when
+ * a different message arrives, on flush and at the latest `timeout` after the first repeat.
+ */
+struct CVSLOGGER_EXPORT Dedup {
+  bool                      enable  = true;
+  std::chrono::milliseconds timeout = std::chrono::milliseconds(1000);
+
+  bool operator==(const Dedup&) const = default;
+};
+
+/**
+ * Flight recorder of a logger. Messages of `level` and higher that are below the logger level are
+ * kept in memory in a ring of `slots` messages instead of being dropped. The ring is written to the
+ * sinks, oldest first, before every message of `dump_level` and higher and on
+ * ILogger::dumpRecorder. With `crash_dump` the rings of all loggers are also written to stderr on
+ * SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT. `level` Level::off disables the recorder.
+ */
+struct CVSLOGGER_EXPORT Recorder {
+  Level       level      = Level::trace;
+  std::size_t slots      = 1024;
+  Level       dump_level = Level::err;
+  bool        crash_dump = false;
+
+  bool operator==(const Recorder&) const = default;
+};
+
+enum class Overflow { block = 0, drop_oldest, drop_newest };
+
+/**
+ * Asynchronous mode of a logger. Messages are queued and written to the sinks by `threads`
+ * background workers. With more than one worker the output order is not guaranteed.
+ * `threads == 0` switches the logger back to synchronous mode.
+ */
+struct CVSLOGGER_EXPORT Async {
+  std::size_t queue_size = 8192;
+  Overflow    overflow   = Overflow::block;
+  std::size_t threads    = 1;
+
+  bool operator==(const Async&) const = default;
+};
 
 class CVSLOGGER_EXPORT Regex : public std::string_view {
  public:
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cvs/logger/configtypes.hpp>
+#include <cvs/logger/cvslogger_export.hpp>
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace cvs::logger {
+
+class ILogger;
+
+}  // namespace cvs::logger
+
+/**
+ * Producer side of Backend::deferred and Backend::binary. A log call copies the format string
+ * pointer and its arguments into a ring of the calling thread. A single backend thread merges all
+ * rings by timestamp and formats the messages to the sinks or writes them to a binary log.
+ */
+namespace cvs::logger::deferred {
+
+// Type of a packed argument. The values are stored in binary logs and must not change.
+enum class Tag : std::uint8_t {
+  boolean = 0,
+  character,
+  i8,
+  u8,
+  i16,
+  u16,
+  i32,
+  u32,
+  i64,
+  u64,
+  f32,
+  f64,
+  string,
+};
+
+template <typename T>
+constexpr bool is_string_v =
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+    std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+    (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>);
+
+template <typename T>
+constexpr bool is_packable_v = std::is_arithmetic_v<T> || is_string_v<T>;
+
+template <typename T>
+constexpr Tag tag() {
+  if constexpr (is_string_v<T>)
+    return Tag::string;
+  else if constexpr (std::is_same_v<T, bool>)
+    return Tag::boolean;
+  else if constexpr (std::is_same_v<T, char>)
+    return Tag::character;
+  else if constexpr (std::is_floating_point_v<T>)
+    return sizeof(T) == 4 ? Tag::f32 : Tag::f64;
+  else if constexpr (sizeof(T) == 1)
+    return std::is_signed_v<T> ? Tag::i8 : Tag::u8;
+  else if constexpr (sizeof(T) == 2)
+    return std::is_signed_v<T> ? Tag::i16 : Tag::u16;
+  else if constexpr (sizeof(T) == 4)
+    return std::is_signed_v<T> ? Tag::i32 : Tag::u32;
+  else
+    return std::is_signed_v<T> ? Tag::i64 : Tag::u64;
+}
+
+// long double has no tag, it is formatted on the calling thread.
+template <typename... Args>
+constexpr bool packable_v =
+    ((is_packable_v<std::remove_cvref_t<Args>> &&
+      !std::is_same_v<std::remove_cvref_t<Args>, long double>)&&...);
+
+struct ArgsInfo {
+  const Tag*  tags;
+  std::size_t count;
+  // Formats packed arguments on the backend thread.
+  std::string (*format)(std::string_view format, const char* data);
+};
+
+struct RecordHeader {
+  std::uint32_t   size;  // Record size with this header and padding. Zero marks the ring end.
+  Level           level;
+  std::uint32_t   format_size;
+  std::int64_t    timestamp;  // Nanoseconds since the epoch.
+  const char*     format;     // Literal format string. Its address identifies the format.
+  const ArgsInfo* args;
+  ILogger*        logger;
+};
+
+/**
+ * Single-producer single-consumer byte ring of one thread. Positions grow monotonically and are
+ * wrapped with a mask. A record that does not fit before the end of the buffer starts at its
+ * beginning, the gap is marked by a zero size.
+ */
+class CVSLOGGER_EXPORT ThreadRing {
+ public:
+  static constexpr std::size_t capacity   = std::size_t(1) << 20;
+  static constexpr std::size_t max_record = capacity / 4;
+
+  ThreadRing();
+
+  char* reserve(std::size_t size) {
+    auto pos    = head.load(std::memory_order_relaxed);
+    auto offset = pos & (capacity - 1);
+    auto room   = capacity - offset;
+    auto need   = size <= room ? size : room + size;
+    if (pos + need - cached_tail > capacity) {
+      cached_tail = tail.load(std::memory_order_acquire);
+      if (pos + need - cached_tail > capacity)
+        return nullptr;
+    }
+    if (size > room) {
+      reinterpret_cast<RecordHeader*>(buffer.get() + offset)->size = 0;
+      pos += room;
+    }
+    reserved = pos;
+    return buffer.get() + (pos & (capacity - 1));
+  }
+
+  void commit(std::size_t size) { head.store(reserved + size, std::memory_order_release); }
+
+  // Consumer side.
+  std::size_t readPos() const { return tail.load(std::memory_order_relaxed); }
+  std::size_t writePos() const { return head.load(std::memory_order_acquire); }
+  const char* at(std::size_t pos) const { return buffer.get() + (pos & (capacity - 1)); }
+  void        release(std::size_t pos) { tail.store(pos, std::memory_order_release); }
+
+  std::atomic_size_t dropped{0};
+
+ private:
+  std::unique_ptr<char[]> buffer;
+
+  alignas(64) std::atomic_size_t head{0};
+  std::size_t reserved    = 0;
+  std::size_t cached_tail = 0;
+
+  alignas(64) std::atomic_size_t tail{0};
+};
+
+// The ring of the calling thread, registered with the backend on first use.
+CVSLOGGER_EXPORT ThreadRing& threadRing();
+// Blocks until every message pushed before the call is formatted or written.
+CVSLOGGER_EXPORT void        flush();
+// Messages lost because a thread ring was full.
+CVSLOGGER_EXPORT std::size_t dropped();
+
+template <typename T>
+std::size_t packedSize(const T& arg) {
+  using Type = std::remove_cvref_t<T>;
+  if constexpr (is_string_v<Type>)
+    return sizeof(std::uint32_t) + std::string_view(arg).size();
+  else
+    return sizeof(Type);
+}
+
+template <typename T>
+void pack(char*& out, const T& arg) {
+  using Type = std::remove_cvref_t<T>;
+  if constexpr (is_string_v<Type>) {
+    std::string_view str(arg);
+    auto             size = std::uint32_t(str.size());
+    std::memcpy(out, &size, sizeof(size));
+    std::memcpy(out + sizeof(size), str.data(), size);
+    out += sizeof(size) + size;
+  } else {
+    std::memcpy(out, &arg, sizeof(Type));
+    out += sizeof(Type);
+  }
+}
+
+template <typename T>
+using Unpacked = std::conditional_t<is_string_v<T>, std::string_view, T>;
+
+template <typename T>
+Unpacked<T> unpack(const char*& in) {
+  if constexpr (is_string_v<T>) {
+    std::uint32_t size;
+    std::memcpy(&size, in, sizeof(size));
+    std::string_view str(in + sizeof(size), size);
+    in += sizeof(size) + size;
+    return str;
+  } else {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+  }
+}
+
+template <typename... Args>
+std::string formatPacked(std::string_view format, [[maybe_unused]] const char* data) {
+  // Braced initialisation unpacks the arguments from left to right.
+  std::tuple<Unpacked<Args>...> values{unpack<Args>(data)...};
+  return std::apply(
+      [&](const auto&... v) { return fmt::vformat(format, fmt::make_format_args(v...)); }, values);
+}
+
+template <typename... Args>
+struct ArgsOf {
+  static constexpr Tag      tags[sizeof...(Args) + 1] = {tag<Args>()..., Tag::boolean};
+  static constexpr ArgsInfo info{tags, sizeof...(Args), &formatPacked<Args...>};
+};
+
+// `format` must be a literal, it is read when the message is formatted or written.
+template <typename... Args>
+void push(ILogger* logger, Level lvl, std::string_view format, const Args&... args) {
+  constexpr auto align   = alignof(RecordHeader);
+  const auto     payload = (std::size_t(0) + ... + packedSize(args));
+  const auto     size    = (sizeof(RecordHeader) + payload + align - 1) / align * align;
+
+  auto& ring = threadRing();
+  char* data = size <= ThreadRing::max_record ? ring.reserve(size) : nullptr;
+  if (!data) {
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  new (data) RecordHeader{std::uint32_t(size),
+                          lvl,
+                          std::uint32_t(format.size()),
+                          timestamp,
+                          format.data(),
+                          &ArgsOf<std::remove_cvref_t<Args>...>::info,
+                          logger};
+
+  char* out = data + sizeof(RecordHeader);
+  (pack(out, args), ...);
+  // Binary logs keep the padding, it is cleared so they are deterministic.
+  std::memset(out, 0, std::size_t(data + size - out));
+  ring.commit(size);
+}
+
+}  // namespace cvs::logger::deferred
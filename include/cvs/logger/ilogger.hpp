@@ -2,15 +2,44 @@
 
 #include <cvs/logger/configtypes.hpp>
 #include <cvs/logger/cvslogger_export.hpp>
+#include <cvs/logger/deferred.hpp>
+#include <cvs/logger/recorder.hpp>
+#include <cvs/logger/stats.hpp>
 
+#include <fmt/compile.h>
 #include <spdlog/logger.h>
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace cvs::logger {
 
+class FrameRing;
+
+/**
+ * Level of a message and its call site. The LOG_* macros fill in the call site, a bare Level
+ * converts to a site without one.
+ */
+struct LogSite {
+  LogSite(Level l, spdlog::source_loc loc = {})
+      : level(l)
+      , source(loc) {}
+
+  Level              level;
+  spdlog::source_loc source;
+};
+
 class CVSLOGGER_EXPORT ILogger {
+  friend class DeferredBackend;
+
  public:
   virtual ~ILogger() = default;
 
@@ -19,11 +48,38 @@ class CVSLOGGER_EXPORT ILogger {
   virtual const std::filesystem::path& path() const     = 0;
   virtual LogImage                     logImage() const = 0;
 
-  virtual bool isEnabled(Level) const = 0;
+  /**
+   * Not virtual, so implementations can't override it: a message is enabled by the level of the
+   * spdlog logger, including a level set on it directly with spdlog::logger::set_level(), or by
+   * the level of the flight recorder.
+   */
+  bool isEnabled(Level l) const {
+    if (logger->should_log(convertLogLevel(l)) ||
+        l >= recorder_level.load(std::memory_order_relaxed))
+      return true;
+    counters->filtered();
+    return false;
+  }
 
+  // Messages lost because the asynchronous queue overflowed.
+  virtual std::size_t dropped() const { return 0; }
+
+  LoggerStats stats() const;
+
+  // Ring file for LogImage::raw, null if the logger does not support it. Holding the pointer keeps
+  // the ring mapped after the logger replaces it.
+  virtual std::shared_ptr<FrameRing> frameRing() { return nullptr; }
+
+  // Writes the messages kept by the flight recorder since its previous dump to the sinks.
+  void dumpRecorder();
+
+  /**
+   * Types without a specialised strategy are passed to fmt by reference. A specialisation sets
+   * `Type` to the value that replaces the argument in the formatted message (see cv::Mat).
+   */
   template <typename T>
   struct Strategy {
-    using Type = T;
+    using Type = const T&;
   };
 
   template <typename T>
@@ -31,16 +87,135 @@ class CVSLOGGER_EXPORT ILogger {
     return arg;
   }
 
+  template <typename T>
+  using ArgType = typename Strategy<T>::Type;
+
+  // Some argument has a specialised strategy, which may save an image.
+  template <typename... Args>
+  static constexpr bool has_strategies_v = (!std::is_reference_v<ArgType<Args>> || ...);
+
+  /**
+   * Paths of the images saved for the message being written on this thread. processArg adds them,
+   * the sinks of the DefaultLogger get them with the message, so JournalSink sets CVS_IMAGE fields
+   * without parsing the text. Messages with images are never deferred.
+   */
+  static std::vector<std::string>& messageImages();
+
+  /**
+   * Arguments of messages kept by the flight recorder skip the strategies, so nothing is saved for
+   * a message that may never be written. A specialised strategy replaces them with a placeholder.
+   */
+  template <typename T>
+  ArgType<T> recordArg(const T& arg) {
+    return arg;
+  }
+
+  // Result of fmt::runtime(), whose text is owned by the caller.
+  using RuntimeFormat = decltype(fmt::runtime(fmt::string_view()));
+
+  // Literal formats are parsed and checked against the processed argument types at compile time.
+  template <typename... Args>
+  void log(LogSite site, fmt::format_string<ArgType<Args>...> fmt, const Args&... args) {
+    auto lvl = site.level;
+    if (auto r = recorderFor(lvl)) [[unlikely]] {
+      fmt::string_view format = fmt;
+      r->record(lvl, {format.data(), format.size()}, recordArg(args)...);
+      return;
+    }
+    if constexpr (deferred::packable_v<ArgType<Args>...> && !has_strategies_v<Args...>) {
+      if (backend.load(std::memory_order_acquire) != Backend::spdlog) [[unlikely]] {
+        fmt::string_view format = fmt;
+        deferred::push(this, lvl, {format.data(), format.size()}, processArg(lvl, args)...);
+        return;
+      }
+    }
+    logger->log(site.source, convertLogLevel(lvl), fmt, processArg(lvl, args)...);
+    releaseImages<Args...>();
+  }
+
+  // Formats wrapped in FMT_COMPILE are compiled to formatting code, nothing is parsed at runtime.
+  template <typename FormatString, typename... Args>
+  requires fmt::detail::is_compiled_string<FormatString>::value
+  void log(LogSite site, const FormatString& fmt, const Args&... args) {
+    fmt::memory_buffer buf;
+    if (auto r = recorderFor(site.level)) [[unlikely]] {
+      fmt::format_to(std::back_inserter(buf), fmt, recordArg(args)...);
+      r->recordFormatted(site.level, "{}", std::string_view(buf.data(), buf.size()));
+      return;
+    }
+    fmt::format_to(std::back_inserter(buf), fmt, processArg(site.level, args)...);
+    logger->log(site.source, convertLogLevel(site.level),
+                spdlog::string_view_t(buf.data(), buf.size()));
+    releaseImages<Args...>();
+  }
+
+  // fmt::runtime() formats may not outlive the call, so they are never deferred or recorded as is.
+  template <typename... Args>
+  void log(LogSite site, RuntimeFormat fmt, const Args&... args) {
+    log(site, std::string_view(fmt.str.data(), fmt.str.size()), args...);
+  }
+
+  // Message of a rate-limited call site, with the number of calls skipped since the previous one.
+  template <typename... Args>
+  void logSuppressed(LogSite                              site,
+                     std::size_t                          suppressed,
+                     fmt::format_string<ArgType<Args>...> fmt,
+                     const Args&... args) {
+    if (suppressed == 0) {
+      log(site, fmt, args...);
+      return;
+    }
+    fmt::memory_buffer buf;
+    if (auto r = recorderFor(site.level)) [[unlikely]] {
+      fmt::format_to(std::back_inserter(buf), fmt, recordArg(args)...);
+      fmt::format_to(std::back_inserter(buf), " (suppressed {})", suppressed);
+      r->recordFormatted(site.level, "{}", std::string_view(buf.data(), buf.size()));
+      return;
+    }
+    fmt::format_to(std::back_inserter(buf), fmt, processArg(site.level, args)...);
+    fmt::format_to(std::back_inserter(buf), " (suppressed {})", suppressed);
+    logger->log(site.source, convertLogLevel(site.level),
+                spdlog::string_view_t(buf.data(), buf.size()));
+    releaseImages<Args...>();
+  }
+
+  template <typename... Args>
+  void logSuppressed(LogSite       site,
+                     std::size_t   suppressed,
+                     RuntimeFormat fmt,
+                     const Args&... args) {
+    if (suppressed == 0)
+      log(site, fmt, args...);
+    else
+      logSuppressed(site, suppressed, fmt::format_string<ArgType<Args>...>(fmt), args...);
+  }
+
+  // Formats only known at runtime are parsed on every call.
   template <typename FormatString, typename... Args>
-  void log(Level lvl, const FormatString& fmt, const Args&... args) {
-    auto arg_tuple = std::apply([&](auto... a) { return std::make_tuple(processArg(lvl, a)...); },
-                                std::make_tuple(args...));
-    std::apply([&](auto... a) { logger->log(convertLogLevel(lvl), fmt, a...); }, arg_tuple);
+  requires(!std::is_array_v<FormatString> &&
+           std::is_convertible_v<const FormatString&, std::string_view>)
+  void log(LogSite site, const FormatString& fmt, const Args&... args) {
+    if (auto r = recorderFor(site.level)) [[unlikely]] {
+      r->recordFormatted(site.level, std::string_view(fmt), recordArg(args)...);
+      return;
+    }
+    logger->log(site.source, convertLogLevel(site.level), fmt::runtime(std::string_view(fmt)),
+                processArg(site.level, args)...);
+    releaseImages<Args...>();
   }
 
  protected:
-  ILogger(std::shared_ptr<spdlog::logger> ptr)
-      : logger(std::move(ptr)) {}
+  // The counters may be shared with the sinks of the logger, which count the emitted messages.
+  ILogger(std::shared_ptr<spdlog::logger> ptr,
+          std::shared_ptr<StatCounters>   stat_counters = std::make_shared<StatCounters>())
+      : logger(std::move(ptr))
+      , counters(std::move(stat_counters)) {}
+
+  // Creates, updates or, with Level::off, disables the flight recorder.
+  void setRecorder(const Recorder&);
+  void setBackend(Backend b);
+  // Publishes the binary log in path() to the backend thread. Called when the path changes.
+  void updateBinaryLog();
 
   static spdlog::level::level_enum convertLogLevel(Level l) {
     switch (l) {
@@ -73,6 +248,42 @@ class CVSLOGGER_EXPORT ILogger {
 
   // While there is no format implementation in std, it will be like this:
   std::shared_ptr<spdlog::logger> logger;
+  std::shared_ptr<StatCounters>   counters;
+
+ private:
+  // The recorder if it keeps messages of level `l`. Dumps it before messages of its dump level.
+  FlightRecorder* recorderFor(Level l) {
+    auto r = recorder.load(std::memory_order_acquire);
+    if (!r || !logger->should_log(convertLogLevel(l)))
+      return r;
+    if (l >= r->dumpLevel())
+      dumpRecorder();
+    return nullptr;
+  }
+
+  // Drops the images that no sink took, for loggers without the DefaultLogger sinks.
+  template <typename... Args>
+  static void releaseImages() {
+    if constexpr (has_strategies_v<Args...>)
+      messageImages().clear();
+  }
+
+  // Name and binary log file of the logger, copied for the backend thread. It can't read path()
+  // while the factory changes it.
+  struct BinaryTarget {
+    std::string           name;
+    std::filesystem::path file;
+  };
+
+  // Level::off without a recorder.
+  std::atomic<Level>   recorder_level{Level::off};
+  std::atomic<Backend> backend{Backend::spdlog};
+
+  std::atomic<std::shared_ptr<const BinaryTarget>> binary_target;
+
+  std::atomic<FlightRecorder*> recorder{nullptr};
+  // Replaced recorders leave the crash dump, but stay alive for the threads still writing to them.
+  std::vector<std::unique_ptr<FlightRecorder>> recorders;
 };
 
 }  // namespace cvs::logger
@@ -92,6 +303,16 @@ struct ILogger::Strategy<cv::Mat> {
 template <>
 ILogger::Strategy<cv::Mat>::Type ILogger::processArg<cv::Mat>(Level l, const cv::Mat& arg);
 
+template <>
+inline ILogger::Strategy<cv::Mat>::Type ILogger::recordArg<cv::Mat>(const cv::Mat&) {
+  return "Img(not recorded)";
+}
+
+// Images are written by a background pool. Blocks until every queued image is on disk.
+CVSLOGGER_EXPORT void        flushImages();
+// Images lost because the background pool queue was full.
+CVSLOGGER_EXPORT std::size_t droppedImages();
+
 }  // namespace cvs::logger
 
 #endif
@@ -1,12 +1,19 @@
 #pragma once
 
 #include <any>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
+#include <cvs/logger/config.hpp>
 #include <cvs/logger/configtypes.hpp>
 #include <cvs/logger/cvslogger_export.hpp>
+#include <cvs/logger/stats.hpp>
 
 namespace cvs::logger {
 
@@ -25,15 +32,23 @@ class CVSLOGGER_EXPORT LoggerFactory {
   }
   static LoggerPtr defaultLogger() { return instance()->defaultLoggerImpl(); }
 
+  // Bumped whenever a previously resolved logger may no longer be the one getLogger() returns.
+  static std::uint64_t cacheGeneration() {
+    return cache_generation.load(std::memory_order_acquire);
+  }
+
+  // Counters of every created logger and their sum.
+  static Stats stats() { return instance()->statsImpl(); }
+
+  // Reapplies all rules to all loggers.
   static void configure() { instance()->configureImpl(); }
+  // Applies the batch at once and reconfigures only the loggers matched by its rules.
+  static void configure(const Config& config) { instance()->configureImpl(config); }
   template <typename Name, typename... Args, typename... Loggers>
   static void configure(Name name, std::tuple<Args...> args, Loggers... loggers) {
-    std::apply(
-        [&](auto... x) {
-          (static_cast<void>(instance()->configureImpl(name, std::make_any<decltype(x)>(x))), ...);
-        },
-        args);
-    configure(loggers...);
+    Config config;
+    addRules(config, std::move(name), std::move(args), std::move(loggers)...);
+    configure(config);
   }
 
  public:
@@ -44,14 +59,57 @@ class CVSLOGGER_EXPORT LoggerFactory {
 
   virtual void configureImpl(Regex, std::any) = 0;
   virtual void configureImpl()                = 0;
+  // Factories without batch support store every option and then reapply all rules.
+  virtual void configureImpl(const Config&);
 
   virtual LoggerPtr getLoggerImpl(std::string_view) = 0;
   virtual LoggerPtr defaultLoggerImpl()             = 0;
 
   virtual std::string logNameToRegexPattern(std::string_view) const = 0;
 
+  // Factories that don't track their loggers report no statistics.
+  virtual Stats statsImpl();
+
+  static void invalidateCache();
+
  private:
+  static void addRules(Config&) {}
+  template <typename Name, typename... Args, typename... Loggers>
+  static void addRules(Config& config, Name name, std::tuple<Args...> args, Loggers... loggers) {
+    std::apply([&](auto... x) { config.set(name, std::move(x)...); }, std::move(args));
+    addRules(config, std::move(loggers)...);
+  }
+
   static std::function<LoggerFactorPtr()> creator;
+  static std::atomic_uint64_t             cache_generation;
+};
+
+/**
+ * Logger handle resolved once and reused until the factory invalidates it.
+ * Used by LOG_GLOB_* and LOG_NAMED_* macros to keep a per-call-site logger.
+ */
+class CVSLOGGER_EXPORT CachedLogger {
+ public:
+  explicit CachedLogger(std::string_view name = LoggerFactory::default_logger_name);
+
+  ILogger* get() {
+    if (generation.load(std::memory_order_acquire) != LoggerFactory::cacheGeneration())
+      [[unlikely]] return refresh();
+    return logger.load(std::memory_order_relaxed);
+  }
+
+ private:
+  ILogger* refresh();
+
+  std::atomic_uint64_t  generation{0};
+  std::atomic<ILogger*> logger{nullptr};
+
+  std::string            name;
+  std::mutex             mutex;
+  LoggerPtr              holder;
+  // Threads may still use a replaced logger through the raw pointer for any time, so every
+  // replaced logger is kept. Loggers are only replaced when a creator is registered.
+  std::vector<LoggerPtr> retired;
 };
 
 }  // namespace cvs::logger
@@ -2,47 +2,191 @@
 
 #include <cvs/logger/ilogger.hpp>
 #include <cvs/logger/loggerfactory.hpp>
+#include <cvs/logger/ratelimit.hpp>
+
+// Level and call site of a message, see LogSite.
+#define CVS_LOGGER_SITE(LEVEL)                    \
+  cvs::logger::LogSite(cvs::logger::Level::LEVEL, \
+                       spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION})
 
 #define LOG_TRACE(CH, ...)                            \
   if (CH && CH->isEnabled(cvs::logger::Level::trace)) \
-  CH->log(cvs::logger::Level::trace, __VA_ARGS__)
+  CH->log(CVS_LOGGER_SITE(trace), __VA_ARGS__)
 #define LOG_DEBUG(CH, ...)                            \
   if (CH && CH->isEnabled(cvs::logger::Level::debug)) \
-  CH->log(cvs::logger::Level::debug, __VA_ARGS__)
+  CH->log(CVS_LOGGER_SITE(debug), __VA_ARGS__)
 #define LOG_INFO(CH, ...)                            \
   if (CH && CH->isEnabled(cvs::logger::Level::info)) \
-  CH->log(cvs::logger::Level::info, __VA_ARGS__)
+  CH->log(CVS_LOGGER_SITE(info), __VA_ARGS__)
 #define LOG_WARN(CH, ...)                            \
   if (CH && CH->isEnabled(cvs::logger::Level::warn)) \
-  CH->log(cvs::logger::Level::warn, __VA_ARGS__)
+  CH->log(CVS_LOGGER_SITE(warn), __VA_ARGS__)
 #define LOG_ERROR(CH, ...)                          \
   if (CH && CH->isEnabled(cvs::logger::Level::err)) \
-  CH->log(cvs::logger::Level::err, __VA_ARGS__)
+  CH->log(CVS_LOGGER_SITE(err), __VA_ARGS__)
 #define LOG_CRITICAL(CH, ...)                            \
   if (CH && CH->isEnabled(cvs::logger::Level::critical)) \
-  CH->log(cvs::logger::Level::critical, __VA_ARGS__)
-
-#define LOG_GLOB_TRACE(args...)                                  \
-  if (auto logger = cvs::logger::LoggerFactory::defaultLogger(); \
-      logger->isEnabled(cvs::logger::Level::trace))              \
-  logger->log(cvs::logger::Level::trace, args)
-#define LOG_GLOB_DEBUG(args...)                                  \
-  if (auto logger = cvs::logger::LoggerFactory::defaultLogger(); \
-      logger->isEnabled(cvs::logger::Level::debug))              \
-  logger->log(cvs::logger::Level::debug, args)
-#define LOG_GLOB_INFO(args...)                                   \
-  if (auto logger = cvs::logger::LoggerFactory::defaultLogger(); \
-      logger->isEnabled(cvs::logger::Level::info))               \
-  logger->log(cvs::logger::Level::info, args)
-#define LOG_GLOB_WARN(args...)                                   \
-  if (auto logger = cvs::logger::LoggerFactory::defaultLogger(); \
-      logger->isEnabled(cvs::logger::Level::warn))               \
-  logger->log(cvs::logger::Level::warn, args)
-#define LOG_GLOB_ERROR(args...)                                  \
-  if (auto logger = cvs::logger::LoggerFactory::defaultLogger(); \
-      logger->isEnabled(cvs::logger::Level::err))                \
-  logger->log(cvs::logger::Level::err, args)
-#define LOG_GLOB_CRITICAL(args...)                               \
-  if (auto logger = cvs::logger::LoggerFactory::defaultLogger(); \
-      logger->isEnabled(cvs::logger::Level::critical))           \
-  logger->log(cvs::logger::Level::critical, args)
+  CH->log(CVS_LOGGER_SITE(critical), __VA_ARGS__)
+
+// Resolves the logger once per call site; see CachedLogger.
+#define CVS_LOGGER_CACHED(NAME)                                      \
+  ([]() -> cvs::logger::ILogger* {                                   \
+    static cvs::logger::CachedLogger cvs_logger_cached_handle{NAME}; \
+    return cvs_logger_cached_handle.get();                           \
+  }())
+
+#define LOG_NAMED_TRACE(NAME, args...)                        \
+  if (auto logger = CVS_LOGGER_CACHED(NAME);                  \
+      logger && logger->isEnabled(cvs::logger::Level::trace)) \
+  logger->log(CVS_LOGGER_SITE(trace), args)
+#define LOG_NAMED_DEBUG(NAME, args...)                        \
+  if (auto logger = CVS_LOGGER_CACHED(NAME);                  \
+      logger && logger->isEnabled(cvs::logger::Level::debug)) \
+  logger->log(CVS_LOGGER_SITE(debug), args)
+#define LOG_NAMED_INFO(NAME, args...)                        \
+  if (auto logger = CVS_LOGGER_CACHED(NAME);                 \
+      logger && logger->isEnabled(cvs::logger::Level::info)) \
+  logger->log(CVS_LOGGER_SITE(info), args)
+#define LOG_NAMED_WARN(NAME, args...)                        \
+  if (auto logger = CVS_LOGGER_CACHED(NAME);                 \
+      logger && logger->isEnabled(cvs::logger::Level::warn)) \
+  logger->log(CVS_LOGGER_SITE(warn), args)
+#define LOG_NAMED_ERROR(NAME, args...)                      \
+  if (auto logger = CVS_LOGGER_CACHED(NAME);                \
+      logger && logger->isEnabled(cvs::logger::Level::err)) \
+  logger->log(CVS_LOGGER_SITE(err), args)
+#define LOG_NAMED_CRITICAL(NAME, args...)                        \
+  if (auto logger = CVS_LOGGER_CACHED(NAME);                     \
+      logger && logger->isEnabled(cvs::logger::Level::critical)) \
+  logger->log(CVS_LOGGER_SITE(critical), args)
+
+#define LOG_GLOB_TRACE(args...) \
+  LOG_NAMED_TRACE(cvs::logger::LoggerFactory::default_logger_name, args)
+#define LOG_GLOB_DEBUG(args...) \
+  LOG_NAMED_DEBUG(cvs::logger::LoggerFactory::default_logger_name, args)
+#define LOG_GLOB_INFO(args...) \
+  LOG_NAMED_INFO(cvs::logger::LoggerFactory::default_logger_name, args)
+#define LOG_GLOB_WARN(args...) \
+  LOG_NAMED_WARN(cvs::logger::LoggerFactory::default_logger_name, args)
+#define LOG_GLOB_ERROR(args...) \
+  LOG_NAMED_ERROR(cvs::logger::LoggerFactory::default_logger_name, args)
+#define LOG_GLOB_CRITICAL(args...) \
+  LOG_NAMED_CRITICAL(cvs::logger::LoggerFactory::default_logger_name, args)
+
+// Rate-limited variants. LOG_*_EVERY_N passes every n-th call, LOG_*_EVERY passes one call per
+// std::chrono duration and LOG_*_FIRST_N the first n calls of the call site. Passed messages end
+// with "(suppressed K)" when calls were skipped before them. Only literal formats are supported.
+#define CVS_LOGGER_LIMITED(CH, LEVEL, STATE, LIMIT, ...)       \
+  if (std::size_t cvs_logger_suppressed = 0;                   \
+      CH && CH->isEnabled(cvs::logger::Level::LEVEL) &&        \
+      ([]() -> cvs::logger::ratelimit::STATE& {                \
+        static cvs::logger::ratelimit::STATE cvs_logger_state; \
+        return cvs_logger_state;                               \
+      }().pass(LIMIT, cvs_logger_suppressed)))                 \
+  CH->logSuppressed(CVS_LOGGER_SITE(LEVEL), cvs_logger_suppressed, __VA_ARGS__)
+
+#define LOG_TRACE_EVERY_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, trace, EveryN, N, __VA_ARGS__)
+#define LOG_TRACE_EVERY(CH, PERIOD, ...) CVS_LOGGER_LIMITED(CH, trace, Every, PERIOD, __VA_ARGS__)
+#define LOG_TRACE_FIRST_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, trace, FirstN, N, __VA_ARGS__)
+#define LOG_DEBUG_EVERY_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, debug, EveryN, N, __VA_ARGS__)
+#define LOG_DEBUG_EVERY(CH, PERIOD, ...) CVS_LOGGER_LIMITED(CH, debug, Every, PERIOD, __VA_ARGS__)
+#define LOG_DEBUG_FIRST_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, debug, FirstN, N, __VA_ARGS__)
+#define LOG_INFO_EVERY_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, info, EveryN, N, __VA_ARGS__)
+#define LOG_INFO_EVERY(CH, PERIOD, ...) CVS_LOGGER_LIMITED(CH, info, Every, PERIOD, __VA_ARGS__)
+#define LOG_INFO_FIRST_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, info, FirstN, N, __VA_ARGS__)
+#define LOG_WARN_EVERY_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, warn, EveryN, N, __VA_ARGS__)
+#define LOG_WARN_EVERY(CH, PERIOD, ...) CVS_LOGGER_LIMITED(CH, warn, Every, PERIOD, __VA_ARGS__)
+#define LOG_WARN_FIRST_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, warn, FirstN, N, __VA_ARGS__)
+#define LOG_ERROR_EVERY_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, err, EveryN, N, __VA_ARGS__)
+#define LOG_ERROR_EVERY(CH, PERIOD, ...) CVS_LOGGER_LIMITED(CH, err, Every, PERIOD, __VA_ARGS__)
+#define LOG_ERROR_FIRST_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, err, FirstN, N, __VA_ARGS__)
+#define LOG_CRITICAL_EVERY_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, critical, EveryN, N, __VA_ARGS__)
+#define LOG_CRITICAL_EVERY(CH, PERIOD, ...) \
+  CVS_LOGGER_LIMITED(CH, critical, Every, PERIOD, __VA_ARGS__)
+#define LOG_CRITICAL_FIRST_N(CH, N, ...) CVS_LOGGER_LIMITED(CH, critical, FirstN, N, __VA_ARGS__)
+
+// Set by the CVSLOGGER_ACTIVE_LEVEL CMake option. Macros of lower levels compile to nothing, so
+// their arguments are neither evaluated nor instantiated.
+#ifndef CVSLOGGER_ACTIVE_LEVEL
+#define CVSLOGGER_ACTIVE_LEVEL 0
+#endif
+
+#define CVS_LOGGER_STRIPPED static_cast<void>(0)
+
+#if CVSLOGGER_ACTIVE_LEVEL > 0
+#undef LOG_TRACE
+#undef LOG_NAMED_TRACE
+#define LOG_TRACE(CH, ...) CVS_LOGGER_STRIPPED
+#define LOG_NAMED_TRACE(NAME, ...) CVS_LOGGER_STRIPPED
+#undef LOG_TRACE_EVERY_N
+#undef LOG_TRACE_EVERY
+#undef LOG_TRACE_FIRST_N
+#define LOG_TRACE_EVERY_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#define LOG_TRACE_EVERY(CH, PERIOD, ...) CVS_LOGGER_STRIPPED
+#define LOG_TRACE_FIRST_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#endif
+
+#if CVSLOGGER_ACTIVE_LEVEL > 1
+#undef LOG_DEBUG
+#undef LOG_NAMED_DEBUG
+#define LOG_DEBUG(CH, ...) CVS_LOGGER_STRIPPED
+#define LOG_NAMED_DEBUG(NAME, ...) CVS_LOGGER_STRIPPED
+#undef LOG_DEBUG_EVERY_N
+#undef LOG_DEBUG_EVERY
+#undef LOG_DEBUG_FIRST_N
+#define LOG_DEBUG_EVERY_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#define LOG_DEBUG_EVERY(CH, PERIOD, ...) CVS_LOGGER_STRIPPED
+#define LOG_DEBUG_FIRST_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#endif
+
+#if CVSLOGGER_ACTIVE_LEVEL > 2
+#undef LOG_INFO
+#undef LOG_NAMED_INFO
+#define LOG_INFO(CH, ...) CVS_LOGGER_STRIPPED
+#define LOG_NAMED_INFO(NAME, ...) CVS_LOGGER_STRIPPED
+#undef LOG_INFO_EVERY_N
+#undef LOG_INFO_EVERY
+#undef LOG_INFO_FIRST_N
+#define LOG_INFO_EVERY_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#define LOG_INFO_EVERY(CH, PERIOD, ...) CVS_LOGGER_STRIPPED
+#define LOG_INFO_FIRST_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#endif
+
+#if CVSLOGGER_ACTIVE_LEVEL > 3
+#undef LOG_WARN
+#undef LOG_NAMED_WARN
+#define LOG_WARN(CH, ...) CVS_LOGGER_STRIPPED
+#define LOG_NAMED_WARN(NAME, ...) CVS_LOGGER_STRIPPED
+#undef LOG_WARN_EVERY_N
+#undef LOG_WARN_EVERY
+#undef LOG_WARN_FIRST_N
+#define LOG_WARN_EVERY_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#define LOG_WARN_EVERY(CH, PERIOD, ...) CVS_LOGGER_STRIPPED
+#define LOG_WARN_FIRST_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#endif
+
+#if CVSLOGGER_ACTIVE_LEVEL > 4
+#undef LOG_ERROR
+#undef LOG_NAMED_ERROR
+#define LOG_ERROR(CH, ...) CVS_LOGGER_STRIPPED
+#define LOG_NAMED_ERROR(NAME, ...) CVS_LOGGER_STRIPPED
+#undef LOG_ERROR_EVERY_N
+#undef LOG_ERROR_EVERY
+#undef LOG_ERROR_FIRST_N
+#define LOG_ERROR_EVERY_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#define LOG_ERROR_EVERY(CH, PERIOD, ...) CVS_LOGGER_STRIPPED
+#define LOG_ERROR_FIRST_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#endif
+
+#if CVSLOGGER_ACTIVE_LEVEL > 5
+#undef LOG_CRITICAL
+#undef LOG_NAMED_CRITICAL
+#define LOG_CRITICAL(CH, ...) CVS_LOGGER_STRIPPED
+#define LOG_NAMED_CRITICAL(NAME, ...) CVS_LOGGER_STRIPPED
+#undef LOG_CRITICAL_EVERY_N
+#undef LOG_CRITICAL_EVERY
+#undef LOG_CRITICAL_FIRST_N
+#define LOG_CRITICAL_EVERY_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#define LOG_CRITICAL_EVERY(CH, PERIOD, ...) CVS_LOGGER_STRIPPED
+#define LOG_CRITICAL_FIRST_N(CH, N, ...) CVS_LOGGER_STRIPPED
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Per-call-site state of the rate-limited LOG_* macros. Every state is a static of its call site
+ * and is updated with relaxed atomics only, so a skipped call costs a few instructions and no
+ * formatting. `pass` reports how many calls were skipped since the previous passed one.
+ */
+namespace cvs::logger::ratelimit {
+
+// Passes the 1st, (n+1)th, (2n+1)th... call.
+class EveryN {
+ public:
+  bool pass(std::uint64_t n, std::size_t& suppressed) {
+    auto call = calls.fetch_add(1, std::memory_order_relaxed);
+    if (n > 1 && call % n != 0)
+      return false;
+    suppressed = call == 0 ? 0 : std::size_t(n > 1 ? n - 1 : 0);
+    return true;
+  }
+
+ private:
+  std::atomic_uint64_t calls{0};
+};
+
+// Passes a call if the previous passed one was at least `period` ago.
+class Every {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  template <typename Rep, typename Period>
+  bool pass(std::chrono::duration<Rep, Period> period, std::size_t& suppressed) {
+    return pass(period, Clock::now(), suppressed);
+  }
+
+  // The call is made at `time`, for callers that already took the time.
+  template <typename Rep, typename Period>
+  bool pass(std::chrono::duration<Rep, Period> period, Clock::time_point time,
+            std::size_t& suppressed) {
+    auto now  = time.time_since_epoch().count();
+    auto next = next_pass.load(std::memory_order_relaxed);
+    auto step = std::chrono::duration_cast<Clock::duration>(period).count();
+    // Of concurrent callers only the one that moves the deadline passes.
+    if (now < next ||
+        !next_pass.compare_exchange_strong(next, now + step, std::memory_order_relaxed)) {
+      skipped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    suppressed = skipped.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  std::atomic<Clock::rep> next_pass{std::numeric_limits<Clock::rep>::min()};
+  std::atomic_size_t skipped{0};
+};
+
+// Passes the first n calls.
+class FirstN {
+ public:
+  bool pass(std::uint64_t n, std::size_t& suppressed) {
+    // The counter is not written any more once the limit is reached.
+    if (calls.load(std::memory_order_relaxed) >= n ||
+        calls.fetch_add(1, std::memory_order_relaxed) >= n)
+      return false;
+    suppressed = 0;
+    return true;
+  }
+
+ private:
+  std::atomic_uint64_t calls{0};
+};
+
+}  // namespace cvs::logger::ratelimit
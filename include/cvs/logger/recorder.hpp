@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cvs/logger/configtypes.hpp>
+#include <cvs/logger/cvslogger_export.hpp>
+#include <cvs/logger/deferred.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace cvs::logger {
+
+/**
+ * Ring of the messages of a logger below its level, see Recorder. A message takes one fixed-size
+ * slot, overwriting the oldest one. Literal formats with packable arguments are stored unformatted
+ * and formatted only when the ring is dumped. Other messages, and those whose arguments don't fit
+ * the slot, are formatted into the slot and truncated to it.
+ *
+ * Writers take a slot with one atomic increment and mark it busy while they fill it, readers check
+ * the mark before and after copying a slot. A slot that is still busy when a writer laps the ring
+ * makes that writer drop its message.
+ *
+ * Recorders are registered for the crash dump until they are retired or destroyed. The crash dump
+ * does not use fmt: it substitutes the packed arguments into the `{}` fields of the format as they
+ * are, ignoring the format specs.
+ */
+class CVSLOGGER_EXPORT FlightRecorder {
+ public:
+  static constexpr std::size_t slot_size = 256;
+
+  struct Slot {
+    std::atomic_uint64_t      seq{0};  // 2 * index + 1 while written, 2 * index + 2 when done.
+    std::int64_t              timestamp;
+    const char*               format;
+    const deferred::ArgsInfo* args;  // Null if `data` is the formatted text.
+    std::uint32_t             format_size;
+    Level                     level;
+    std::uint16_t             size;
+    char                      data[slot_size - 42];
+  };
+  static_assert(sizeof(Slot) == slot_size);
+
+  // `slots` is rounded up to a power of two.
+  FlightRecorder(std::string_view name, const Recorder&);
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder&)            = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  Level       level() const { return lvl.load(std::memory_order_relaxed); }
+  Level       dumpLevel() const { return dump_lvl.load(std::memory_order_relaxed); }
+  std::size_t capacity() const { return mask + 1; }
+  // Messages lost to a busy slot.
+  std::size_t dropped() const { return dropped_cnt.load(std::memory_order_relaxed); }
+
+  void setLevels(Level level, Level dump_level);
+  // Leaves the crash dump, for a recorder replaced by a new one.
+  void retire();
+
+  // Live recorders left out of the crash dump because the registry was full.
+  static std::size_t unregistered();
+
+  // `format` must be a literal, packed arguments are formatted with it when the ring is dumped.
+  template <typename... Args>
+  void record(Level l, std::string_view format, const Args&... args) {
+    auto slot = acquire(l);
+    if (!slot)
+      return;
+
+    if constexpr (deferred::packable_v<Args...>) {
+      auto payload = (std::size_t(0) + ... + deferred::packedSize(args));
+      if (payload <= sizeof(slot->data)) {
+        [[maybe_unused]] char* out = slot->data;
+        (deferred::pack(out, args), ...);
+        slot->format      = format.data();
+        slot->format_size = std::uint32_t(format.size());
+        slot->args        = &deferred::ArgsOf<std::remove_cvref_t<Args>...>::info;
+        slot->size        = std::uint16_t(payload);
+        publish(slot);
+        return;
+      }
+    }
+
+    formatInto(slot, format, args...);
+    publish(slot);
+  }
+
+  // Formats the message into the slot, for runtime formats whose text may not outlive the call.
+  template <typename... Args>
+  void recordFormatted(Level l, std::string_view format, const Args&... args) {
+    auto slot = acquire(l);
+    if (!slot)
+      return;
+    formatInto(slot, format, args...);
+    publish(slot);
+  }
+
+  /**
+   * Calls `sink` with the messages recorded since the previous dump, oldest first. Messages
+   * overwritten or still being written meanwhile are skipped.
+   */
+  void dump(const std::function<void(Level, std::chrono::nanoseconds, std::string_view)>& sink);
+
+  // Writes the messages of all recorders to `fd` without locking or allocating, see Recorder.
+  static void dumpAll(int fd);
+
+ private:
+  Slot* acquire(Level l) {
+    auto index = head.fetch_add(1, std::memory_order_relaxed);
+    auto slot  = &slots[index & mask];
+    auto seq   = slot->seq.load(std::memory_order_relaxed);
+    if ((seq & 1) ||
+        !slot->seq.compare_exchange_strong(seq, 2 * index + 1, std::memory_order_acquire)) {
+      dropped_cnt.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    slot->level     = l;
+    slot->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+    return slot;
+  }
+  template <typename... Args>
+  static void formatInto(Slot* slot, std::string_view format, const Args&... args) {
+    try {
+      auto result = fmt::format_to_n(slot->data, sizeof(slot->data), fmt::runtime(format), args...);
+      slot->size  = std::uint16_t(std::min(result.size, sizeof(slot->data)));
+    }
+    catch (const std::exception& e) {
+      slot->size = std::uint16_t(std::min(std::strlen(e.what()), sizeof(slot->data)));
+      std::memcpy(slot->data, e.what(), slot->size);
+    }
+    slot->args = nullptr;
+  }
+  void publish(Slot* slot) {
+    slot->seq.store(slot->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Copies the complete slots of [from, to) and passes them to `fn`.
+  template <typename Fn>
+  void read(std::uint64_t from, std::uint64_t to, Fn&& fn) const;
+  void dumpTo(int fd) const;
+
+  const std::string       name;
+  const std::uint64_t     mask;
+  std::unique_ptr<Slot[]> slots;
+  std::atomic<Level>      lvl;
+  std::atomic<Level>      dump_lvl;
+  std::atomic_size_t      dropped_cnt{0};
+
+  // Registry entry of the recorder, null if the registry was full.
+  std::atomic<FlightRecorder*>* registration = nullptr;
+  bool                          retired      = false;
+
+  alignas(64) std::atomic_uint64_t head{0};
+  // End of the last dump, earlier messages are not dumped again.
+  alignas(64) std::atomic_uint64_t dumped{0};
+};
+
+// Dumps the recorders of all loggers to stderr on fatal signals, see Recorder::crash_dump.
+CVSLOGGER_EXPORT void installCrashHandler();
+
+}  // namespace cvs::logger
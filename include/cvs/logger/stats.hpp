@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cvs/logger/cvslogger_export.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace cvs::logger {
+
+/**
+ * Counters of a logger since its creation. `sink_time` is estimated from every 64th message of the
+ * logger, the other counters are exact.
+ */
+struct CVSLOGGER_EXPORT LoggerStats {
+  std::size_t              emitted     = 0;  // Messages and repeat counts passed to the sinks.
+  std::size_t              filtered    = 0;  // Calls below the logger level.
+  std::size_t              bytes       = 0;  // Formatted message text.
+  std::size_t              dropped     = 0;  // Messages lost by the asynchronous queue.
+  std::chrono::nanoseconds sink_time   = std::chrono::nanoseconds(0);
+  std::size_t              images      = 0;  // Images passed to the PNG writer or the raw ring.
+  std::size_t              image_bytes = 0;
+
+  LoggerStats& operator+=(const LoggerStats&);
+};
+
+// Snapshot of all created loggers, see LoggerFactory::stats.
+struct CVSLOGGER_EXPORT Stats {
+  LoggerStats                        total;
+  std::map<std::string, LoggerStats> loggers;
+};
+
+/**
+ * Counters of LoggerStats split into cache-line shards. A thread always updates the same shard
+ * with relaxed atomics, so threads logging to one logger don't contend on its counters. Filtered
+ * calls are counted in slots of the calling thread instead, see ThreadSlots.
+ */
+class CVSLOGGER_EXPORT StatCounters {
+ public:
+  static constexpr std::size_t shard_count     = 8;
+  static constexpr unsigned    sink_time_every = 64;
+
+  StatCounters();
+  ~StatCounters();
+
+  StatCounters(const StatCounters&)            = delete;
+  StatCounters& operator=(const StatCounters&) = delete;
+
+  // Disabled calls must stay cheap, so the slot of the thread is not updated with a locked
+  // instruction. The shards are only used once all slot ids are taken.
+  void filtered() {
+    if (id < ThreadSlots::max_ids) [[likely]] {
+      auto& counter = ThreadSlots::current().at(id);
+      counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    } else
+      shard().filtered.fetch_add(1, std::memory_order_relaxed);
+  }
+  void emitted(std::size_t bytes) {
+    auto& s = shard();
+    s.emitted.fetch_add(1, std::memory_order_relaxed);
+    s.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  void image(std::size_t bytes) {
+    auto& s = shard();
+    s.images.fetch_add(1, std::memory_order_relaxed);
+    s.image_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // True for the messages of the logger whose sink time is measured.
+  bool sampleSinkTime() {
+    auto& tick = shard().tick;
+    auto  next = tick.load(std::memory_order_relaxed) + 1;
+    tick.store(next, std::memory_order_relaxed);
+    return next % sink_time_every == 0;
+  }
+  void sinkTime(std::chrono::nanoseconds sample) {
+    shard().sink_ns.fetch_add(std::size_t(sample.count()) * sink_time_every,
+                              std::memory_order_relaxed);
+  }
+
+  LoggerStats load() const;
+
+ private:
+  /**
+   * Filtered calls counted by one thread, a slot per StatCounters id. The slots are allocated in
+   * chunks that never move, so load() sums them while the thread counts. A thread adds its counts
+   * to the totals of the ids on exit.
+   */
+  class CVSLOGGER_EXPORT ThreadSlots {
+   public:
+    static constexpr std::size_t chunk_size = 64;
+    static constexpr std::size_t max_chunks = 256;
+    static constexpr std::size_t max_ids    = chunk_size * max_chunks;
+
+    using Chunk = std::array<std::atomic_size_t, chunk_size>;
+
+    ThreadSlots();
+    ~ThreadSlots();
+
+    // Slots of the calling thread. The pointer is constant-initialized, so the fast path skips
+    // the initialization check of the thread_local object.
+    static ThreadSlots& current() {
+      if (!local) [[unlikely]]
+        local = &create();
+      return *local;
+    }
+
+    std::atomic_size_t& at(std::size_t id) {
+      auto chunk = chunks[id / chunk_size].load(std::memory_order_relaxed);
+      if (!chunk) [[unlikely]]
+        chunk = allocate(id / chunk_size);
+      return (*chunk)[id % chunk_size];
+    }
+
+    // Value of the slot `id`, called under the lock of the slot registry.
+    std::size_t load(std::size_t id) const;
+    // Clears the slot `id` for a new StatCounters, called under the lock of the slot registry.
+    void reset(std::size_t id);
+
+   private:
+    static ThreadSlots& create();
+    Chunk*              allocate(std::size_t index);
+
+    static inline thread_local constinit ThreadSlots* local = nullptr;
+
+    std::array<std::atomic<Chunk*>, max_chunks> chunks{};
+  };
+
+  struct alignas(64) Shard {
+    std::atomic_size_t filtered{0};
+    std::atomic_size_t emitted{0};
+    std::atomic_size_t bytes{0};
+    std::atomic_size_t sink_ns{0};
+    std::atomic_size_t images{0};
+    std::atomic_size_t image_bytes{0};
+    std::atomic_uint   tick{0};  // Messages of the shard, for sampleSinkTime().
+  };
+
+  static std::size_t shardIndex();
+
+  Shard& shard() {
+    thread_local const std::size_t index = shardIndex();
+    return shards[index];
+  }
+
+  std::array<Shard, shard_count> shards;
+  const std::size_t              id;  // Slot of the filtered calls, max_ids if none was free.
+};
+
+}  // namespace cvs::logger
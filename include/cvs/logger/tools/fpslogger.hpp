@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cvs/logger/tools/histogram.hpp>
+
 #include <chrono>
 #include <memory>
 #include <string_view>
@@ -7,42 +9,79 @@
 
 namespace cvs::logger::tools {
 
+/**
+ * Counts frames and reports the frame rate to the logger `name`. `newFrame` may be called from any
+ * number of threads, the frames of all threads make up one stream. The frame path updates atomics
+ * only and takes no locks. Times are taken from the monotonic clock. The frame intervals are
+ * collected in a Histogram, the periodic reports give the percentiles of the period.
+ *
+ * The periodic reports of all FpsLoggers are written by one background thread, so frames don't pay
+ * for them. The thread can also write a combined report of all started FpsLoggers.
+ */
 class FpsLogger {
   class Private;
+  class CombinedReport;
 
  public:
-  using clock      = std::chrono::system_clock;
+  using clock      = std::chrono::steady_clock;
   using duration   = clock::duration;
   using time_point = clock::time_point;
 
+  // Percentiles and the maximum of the frame intervals since start or clear, `window_fps` is the
+  // rate over the last window.
   struct TotalStat {
     double      last_fps, smma_fps, fps;
     std::size_t total_cnt;
+    duration    p50, p90, p99, p999, max;
+    double      window_fps;
   };
 
+  // Number of buckets of the sliding window, see setWindow.
+  static constexpr std::size_t window_buckets = 64;
+
   FpsLogger(std::string_view name = "cvs.logger.tools.fsplogger");
   virtual ~FpsLogger();
 
+  // Reports the frames of all FpsLoggers to the logger `name` every `period`, zero disables.
+  static void setCombinedReport(duration period,
+                                std::string_view name = "cvs.logger.tools.fsplogger");
+  // Writes the enabled periodic and combined reports now and returns once they are written.
+  static void flushReports();
+
   void   setRo(double);
   double ro() const;
 
-  void            setReportDuration(duration);
-  const duration& reportDuration() const;
+  // Period of the reports of this logger, zero disables them. Periods below 1 ms take 1 ms.
+  void     setReportDuration(duration);
+  duration reportDuration() const;
 
   void setAutoreport(bool);
   bool autoreport() const;
 
+  /**
+   * Length of the window of windowFps, 5 seconds by default. Frames are counted in
+   * `window_buckets` buckets of the window, so the rate is exact up to the bucket boundaries and
+   * both counting and reading take constant time. Changing the window drops the counted frames.
+   */
+  void     setWindow(duration);
+  duration window() const;
+  double   windowFps() const;
+
   double    fps() const;
   double    smmaFps() const;
   double    lastFps() const;
   TotalStat getStat() const;
-  void      setUseLock(bool use_lock = true);
+  // Frame intervals since start or clear, may be merged into the histogram of another logger.
+  const Histogram& histogram() const;
+
+  [[deprecated("FpsLogger is always thread-safe")]] void setUseLock(bool use_lock = true);
 
   void start();
   bool started() const;
   void stop();
 
   void newFrame(time_point frame_time = clock::now());
+  // Frames recorded concurrently may be counted before or after the reset.
   void clear();
 
   std::size_t framesCount() const;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cvs/logger/cvslogger_export.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace cvs::logger::tools {
+
+/**
+ * Fixed-size histogram of durations with logarithmic buckets, like HdrHistogram. Every power of two
+ * is split into 32 buckets, so a percentile is within 3% of the recorded value. Durations up to
+ * 2^42 ns (73 minutes) are resolved, longer ones fall into the last bucket. `record` is a relaxed
+ * increment and may be called from any number of threads.
+ */
+class CVSLOGGER_EXPORT Histogram {
+ public:
+  using duration = std::chrono::nanoseconds;
+
+  static constexpr unsigned    sub_bucket_bits = 5;
+  static constexpr unsigned    max_bits        = 42;
+  static constexpr std::size_t bucket_count =
+      (std::size_t(1) << sub_bucket_bits) * (max_bits - sub_bucket_bits + 1);
+
+  void record(duration);
+
+  std::uint64_t count() const;
+  duration      max() const;
+  // The upper bound of the bucket holding the `p` percent smallest values, zero if empty.
+  duration percentile(double p) const;
+
+  // Adds the counts of another histogram, for example of another FpsLogger.
+  void merge(const Histogram&);
+  // Moves the counts of `other` into this histogram. Concurrent records of `other` are not lost.
+  void drain(Histogram& other);
+  void clear();
+
+ private:
+  static std::size_t   bucketIndex(std::uint64_t value);
+  static std::uint64_t bucketHigh(std::size_t index);
+
+  std::array<std::atomic_uint64_t, bucket_count> buckets{};
+  std::atomic_uint64_t                           max_value{0};
+};
+
+}  // namespace cvs::logger::tools
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cvs/logger/cvslogger_export.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cvs::logger::tools {
+
+/**
+ * Measures where the time of a frame goes. Durations of named stages are recorded into histograms
+ * of the recording thread, which are merged when the stats are read or reported. A stage timed
+ * inside another one becomes its nested stage, reported as `<parent>/<stage>`. Reports go to the
+ * logger `name` every report period, as debug messages with the mean, the percentiles and the
+ * share of the frame budget of every stage. Without a budget the share is taken of the time of the
+ * top-level stages. The periodic reports are written by the thread of the FpsLogger reports.
+ */
+class CVSLOGGER_EXPORT StageTracker {
+  class Private;
+
+ public:
+  using clock      = std::chrono::steady_clock;
+  using duration   = clock::duration;
+  using time_point = clock::time_point;
+
+  static constexpr std::size_t max_stages = 32;
+
+  struct StageStat {
+    std::string   path;
+    std::uint64_t count;
+    duration      mean, p50, p90, p99, max;
+    double        share;
+  };
+
+  // Stage id cached by a call site of STAGE_TIMER.
+  class Site {
+    friend StageTracker;
+    std::atomic_uint64_t id{0};  // Tracker uid << 8 | stage.
+  };
+
+  // Times the enclosing scope as `stage`, see STAGE_TIMER.
+  class CVSLOGGER_EXPORT Scope {
+   public:
+    Scope(StageTracker&, std::size_t stage);
+    ~Scope();
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    StageTracker&     tracker;
+    const std::size_t stage;
+    Scope* const      parent;
+    const time_point  start;
+  };
+
+  StageTracker(std::string_view name = "cvs.logger.tools.stagetracker");
+  ~StageTracker();
+
+  /**
+   * Id of the stage `name`. The first call registers the stage, which locks and allocates, later
+   * calls only compare the name with the registered ones. Throws std::length_error if there are
+   * already `max_stages` stages.
+   */
+  std::size_t stage(std::string_view name);
+  // Id of the stage `name`, taken from `site` after the first call with this tracker.
+  std::size_t stage(std::string_view name, Site& site) {
+    auto cached = site.id.load(std::memory_order_relaxed);
+    if (cached >> 8 == uid) [[likely]]
+      return std::size_t(cached & 0xff);
+    auto id = stage(name);
+    site.id.store(uid << 8 | id, std::memory_order_relaxed);
+    return id;
+  }
+
+  void record(std::size_t stage, duration);
+
+  void     setFrameBudget(duration);
+  duration frameBudget() const;
+
+  // Period of the reports, zero disables them. Periods below 1 ms take 1 ms.
+  void     setReportDuration(duration);
+  duration reportDuration() const;
+
+  void setAutoreport(bool);
+  bool autoreport() const;
+
+  // Stats of the stages since the last report, ordered by path.
+  std::vector<StageStat> getStat() const;
+  // Writes the report now and starts a new period.
+  std::vector<StageStat> report();
+
+ private:
+  std::shared_ptr<Private> m;
+  const std::uint64_t      uid;
+};
+
+}  // namespace cvs::logger::tools
+
+#define CVS_LOGGER_STAGE_TIMER_NAME(LINE) cvs_logger_stage_timer_##LINE
+#define CVS_LOGGER_STAGE_SITE_NAME(LINE) cvs_logger_stage_site_##LINE
+#define CVS_LOGGER_STAGE_TIMER(TRACKER, NAME, LINE)                                   \
+  static cvs::logger::tools::StageTracker::Site CVS_LOGGER_STAGE_SITE_NAME(LINE);      \
+  cvs::logger::tools::StageTracker::Scope       CVS_LOGGER_STAGE_TIMER_NAME(LINE)(     \
+      (TRACKER), (TRACKER).stage(NAME, CVS_LOGGER_STAGE_SITE_NAME(LINE)))
+
+/**
+ * Records the time until the end of the enclosing scope as the stage NAME of TRACKER. The stage id
+ * is cached at the call site, so NAME must be the same on every pass.
+ */
+#define STAGE_TIMER(TRACKER, NAME) CVS_LOGGER_STAGE_TIMER(TRACKER, NAME, __LINE__)
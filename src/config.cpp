@@ -0,0 +1,322 @@
+#include "../include/cvs/logger/config.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+using namespace cvs::logger;
+
+namespace {
+
+template <typename T>
+struct Named {
+  std::string_view name;
+  T                value;
+};
+
+constexpr Named<Level> levels[] = {{"trace", Level::trace}, {"debug", Level::debug},
+                                   {"info", Level::info},   {"warn", Level::warn},
+                                   {"err", Level::err},     {"critical", Level::critical},
+                                   {"off", Level::off}};
+
+constexpr Named<Sinks> sink_names[] = {{"none", Sinks::NOSINK},
+                                       {"stdout", Sinks::STDOUT},
+                                       {"systemd", Sinks::SYSTEMD},
+                                       {"file", Sinks::FILE}};
+
+constexpr Named<TimeType> time_types[] = {{"local", TimeType::local}, {"utc", TimeType::utc}};
+
+constexpr Named<LogImage> log_images[] = {
+    {"disable", LogImage::disable}, {"enable", LogImage::enable}, {"raw", LogImage::raw}};
+
+constexpr Named<Backend> backends[] = {
+    {"spdlog", Backend::spdlog}, {"deferred", Backend::deferred}, {"binary", Backend::binary}};
+
+constexpr Named<Overflow> overflows[] = {{"block", Overflow::block},
+                                         {"drop_oldest", Overflow::drop_oldest},
+                                         {"drop_newest", Overflow::drop_newest}};
+
+constexpr Named<bool> bools[] = {{"true", true}, {"on", true},   {"yes", true}, {"1", true},
+                                 {"false", false}, {"off", false}, {"no", false}, {"0", false}};
+
+std::string_view trim(std::string_view s) {
+  auto begin = s.find_first_not_of(" \t\r");
+  if (begin == std::string_view::npos)
+    return {};
+  return s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
+}
+
+// Options of the current section. Struct options are built from their fields at its end.
+struct Section {
+  Config::Rule               rule;
+  std::optional<std::string> pattern;
+  TimeType                   time_type = TimeType::local;
+  std::size_t                time_line = 0;  // Line of the time option, it needs a pattern.
+  std::optional<LogFile>     log_file;
+  std::optional<Async>       async;
+  std::optional<Dedup>       dedup;
+  std::optional<Recorder>    recorder;
+  std::optional<std::size_t> image_ring;
+};
+
+class Parser {
+ public:
+  Parser(std::string_view src)
+      : source(src) {}
+
+  Config parse(std::string_view text);
+
+ private:
+  [[noreturn]] void fail(const std::string& what) const {
+    throw std::invalid_argument(std::string(source) + ":" + std::to_string(line) + ": " + what);
+  }
+
+  template <typename T, std::size_t N>
+  T lookup(const Named<T> (&names)[N], std::string_view value) const {
+    auto iter = std::find_if(std::begin(names), std::end(names),
+                             [value](const Named<T>& n) { return n.name == value; });
+    if (iter == std::end(names))
+      fail("Unknown value " + std::string(value));
+    return iter->value;
+  }
+
+  std::uint64_t            number(std::string_view value, std::string_view* suffix) const;
+  std::size_t              size(std::string_view value) const;
+  std::chrono::nanoseconds time(std::string_view value) const;
+  Sinks                    sinks(std::string_view value) const;
+
+  void set(std::string_view key, std::string_view value);
+  void finish();
+
+  std::string_view       source;
+  std::size_t            line = 0;
+  std::optional<Section> section;
+  Config                 config;
+};
+
+std::uint64_t Parser::number(std::string_view value, std::string_view* suffix) const {
+  std::uint64_t result = 0;
+  auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+  if (ec != std::errc() || end == value.data())
+    fail("Invalid number " + std::string(value));
+  *suffix = trim(value.substr(std::size_t(end - value.data())));
+  return result;
+}
+
+std::size_t Parser::size(std::string_view value) const {
+  std::string_view suffix;
+  auto             n = number(value, &suffix);
+  if (suffix.empty())
+    return n;
+  if (suffix == "K")
+    return n << 10;
+  if (suffix == "M")
+    return n << 20;
+  if (suffix == "G")
+    return n << 30;
+  fail("Unknown size suffix " + std::string(suffix));
+}
+
+std::chrono::nanoseconds Parser::time(std::string_view value) const {
+  using namespace std::chrono;
+
+  std::string_view suffix;
+  auto             n = number(value, &suffix);
+  if (suffix == "ms")
+    return milliseconds(n);
+  if (suffix == "s" || suffix.empty())
+    return seconds(n);
+  if (suffix == "min")
+    return minutes(n);
+  if (suffix == "h")
+    return hours(n);
+  fail("Unknown time suffix " + std::string(suffix));
+}
+
+Sinks Parser::sinks(std::string_view value) const {
+  auto result = Sinks::NOSINK;
+  while (!value.empty()) {
+    auto pos = value.find('|');
+    result   = result | lookup(sink_names, trim(value.substr(0, pos)));
+    value    = pos == std::string_view::npos ? std::string_view() : value.substr(pos + 1);
+  }
+  return result;
+}
+
+void Parser::set(std::string_view key, std::string_view value) {
+  using namespace std::chrono;
+
+  if (!section)
+    fail("Option " + std::string(key) + " outside of a section");
+  auto& s       = *section;
+  auto& options = s.rule.options;
+
+  if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+    value = value.substr(1, value.size() - 2);
+
+  auto dot = key.find('.');
+  if (dot != std::string_view::npos) {
+    auto group = key.substr(0, dot);
+    auto field = key.substr(dot + 1);
+    if (group == "file") {
+      auto& f = s.log_file ? *s.log_file : s.log_file.emplace();
+      if (field == "max_size")
+        f.max_size = size(value);
+      else if (field == "max_age")
+        f.max_age = duration_cast<seconds>(time(value));
+      else if (field == "buffer_size")
+        f.buffer_size = size(value);
+      else if (field == "flush_level")
+        f.flush_level = lookup(levels, value);
+      else if (field == "flush_interval")
+        f.flush_interval = duration_cast<milliseconds>(time(value));
+      else if (field == "mmap")
+        f.mmap = lookup(bools, value);
+      else if (field == "compress")
+        f.compress = lookup(bools, value);
+      else if (field == "retention")
+        f.retention = size(value);
+      else
+        fail("Unknown option " + std::string(key));
+    } else if (group == "async") {
+      auto& a = s.async ? *s.async : s.async.emplace();
+      if (field == "queue_size")
+        a.queue_size = size(value);
+      else if (field == "overflow")
+        a.overflow = lookup(overflows, value);
+      else if (field == "threads")
+        a.threads = size(value);
+      else
+        fail("Unknown option " + std::string(key));
+    } else if (group == "dedup") {
+      auto& d = s.dedup ? *s.dedup : s.dedup.emplace();
+      if (field == "enable")
+        d.enable = lookup(bools, value);
+      else if (field == "timeout")
+        d.timeout = duration_cast<milliseconds>(time(value));
+      else
+        fail("Unknown option " + std::string(key));
+    } else if (group == "recorder") {
+      auto& r = s.recorder ? *s.recorder : s.recorder.emplace();
+      if (field == "level")
+        r.level = lookup(levels, value);
+      else if (field == "slots")
+        r.slots = size(value);
+      else if (field == "dump_level")
+        r.dump_level = lookup(levels, value);
+      else if (field == "crash_dump")
+        r.crash_dump = lookup(bools, value);
+      else
+        fail("Unknown option " + std::string(key));
+    } else
+      fail("Unknown option " + std::string(key));
+    return;
+  }
+
+  if (key == "level")
+    options.emplace_back(lookup(levels, value));
+  else if (key == "pattern")
+    s.pattern = std::string(value);
+  else if (key == "time") {
+    s.time_type = lookup(time_types, value);
+    s.time_line = line;
+  }
+  else if (key == "path")
+    options.emplace_back(std::filesystem::path(value));
+  else if (key == "sinks")
+    options.emplace_back(sinks(value));
+  else if (key == "log_image")
+    options.emplace_back(lookup(log_images, value));
+  else if (key == "image_ring")
+    s.image_ring = size(value);
+  else if (key == "backend")
+    options.emplace_back(lookup(backends, value));
+  else
+    fail("Unknown option " + std::string(key));
+}
+
+void Parser::finish() {
+  if (!section)
+    return;
+
+  auto& s       = *section;
+  auto& options = s.rule.options;
+  if (s.time_line && !s.pattern) {
+    line = s.time_line;
+    fail("Option time without pattern");
+  }
+  if (s.pattern)
+    options.emplace_back(Config::PatternOption{std::move(*s.pattern), s.time_type});
+  if (s.log_file)
+    options.emplace_back(*s.log_file);
+  if (s.async)
+    options.emplace_back(*s.async);
+  if (s.dedup)
+    options.emplace_back(*s.dedup);
+  if (s.recorder)
+    options.emplace_back(*s.recorder);
+  if (s.image_ring)
+    options.emplace_back(ImageRing{*s.image_ring});
+
+  config.add(std::move(s.rule));
+  section.reset();
+}
+
+Config Parser::parse(std::string_view text) {
+  while (!text.empty()) {
+    ++line;
+    auto end     = text.find('\n');
+    auto content = trim(text.substr(0, end));
+    text         = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+
+    if (content.empty() || content.front() == '#')
+      continue;
+
+    if (content.front() == '[') {
+      if (content.back() != ']')
+        fail("Unterminated section " + std::string(content));
+      finish();
+      auto name = trim(content.substr(1, content.size() - 2));
+      section.emplace();
+      if (name.substr(0, 6) == "regex ") {
+        section->rule.regex = true;
+        name                = trim(name.substr(6));
+      }
+      section->rule.name = std::string(name);
+      continue;
+    }
+
+    auto eq = content.find('=');
+    if (eq == std::string_view::npos)
+      fail("Expected key = value, got " + std::string(content));
+    set(trim(content.substr(0, eq)), trim(content.substr(eq + 1)));
+  }
+  finish();
+  return std::move(config);
+}
+
+}  // namespace
+
+namespace cvs::logger {
+
+Config Config::parse(std::string_view text, std::string_view source) {
+  return Parser(source).parse(text);
+}
+
+Config Config::load(const std::filesystem::path& file) {
+  std::ifstream stream(file);
+  if (!stream)
+    throw std::system_error(errno, std::generic_category(), "Can't read " + file.string());
+
+  std::stringstream text;
+  text << stream.rdbuf();
+  return parse(text.str(), file.string());
+}
+
+}  // namespace cvs::logger
@@ -1,11 +1,16 @@
 #include "defaultfactory.hpp"
 #include "../include/cvs/logger/ilogger.hpp"
+#include "../framering.hpp"
+#include "dispatchsink.hpp"
+#include "filesink.hpp"
+#include "journalsink.hpp"
 
 #include <spdlog/sinks/stdout_color_sinks.h>
-#include <spdlog/sinks/systemd_sink.h>
 #include <spdlog/spdlog.h>
 
-#include <regex>
+#include <algorithm>
+#include <type_traits>
+#include <variant>
 
 using namespace cvs::logger;
 
@@ -35,11 +40,11 @@ spdlog::pattern_time_type convertTimeType(TimeType tt) {
 }
 
 using StdoutSink  = spdlog::sinks::stdout_color_sink_mt;
-using SystemdSink = spdlog::sinks::systemd_sink_st;
+using SystemdSink = JournalSink;
 
-template <typename SinkType>
-auto createSink(bool enable) {
-  auto sink = std::make_shared<SinkType>();
+template <typename SinkType, typename... Args>
+auto createSink(bool enable, Args&&... args) {
+  auto sink = std::make_shared<SinkType>(std::forward<Args>(args)...);
   sink->set_level(enable ? spdlog::level::trace : spdlog::level::off);
   return sink;
 }
@@ -52,8 +57,13 @@ class DefaultLogger : public ILogger {
   friend DefaultLoggerFactory;
 
  public:
-  DefaultLogger(std::shared_ptr<spdlog::logger> ptr)
-      : ILogger(std::move(ptr)) {}
+  DefaultLogger(std::shared_ptr<spdlog::logger> ptr,
+                std::shared_ptr<StatCounters>   stat_counters,
+                std::shared_ptr<DispatchSink>   sink,
+                std::shared_ptr<FileSink>       file)
+      : ILogger(std::move(ptr), std::move(stat_counters))
+      , dispatch(std::move(sink))
+      , file_sink(std::move(file)) {}
 
   std::string_view name() const override;
   LogImage         logImage() const override;
@@ -61,52 +71,203 @@ class DefaultLogger : public ILogger {
   Level                        level() const override;
   const std::filesystem::path& path() const override;
 
-  bool isEnabled(Level) const override;
+  std::size_t                dropped() const override;
+  std::shared_ptr<FrameRing> frameRing() override;
 
+  std::filesystem::path ringFile() const;
+  // Replaces the ring on the next raw image if its file or size changed. Locks `ring_mutex`.
+  void updateRing(const std::optional<ImageRing>& image_ring);
+
+  std::shared_ptr<DispatchSink> dispatch;
+  std::shared_ptr<FileSink>     file_sink;
   std::filesystem::path p         = std::filesystem::temp_directory_path();
   LogImage              log_image = LogImage::disable;
+
+  // The last pattern set by the factory.
+  std::optional<std::string> pattern;
+  TimeType                   time_type = TimeType::local;
+
+  // The ring is opened on the first raw image. A replaced ring is unmapped when the last writer
+  // that loaded it releases it. `ring_size` is guarded by `ring_mutex`.
+  std::size_t                             ring_size = ImageRing{}.bytes;
+  std::atomic<std::shared_ptr<FrameRing>> ring;
+  std::mutex                              ring_mutex;
 };
 
 std::string_view DefaultLogger::name() const { return logger->name(); }
 LogImage         DefaultLogger::logImage() const { return log_image; }
 Level            DefaultLogger::level() const { return convertLogLevel(logger->level()); }
 const std::filesystem::path& DefaultLogger::path() const { return p; }
-bool DefaultLogger::isEnabled(Level l) const { return logger->should_log(convertLogLevel(l)); }
+std::size_t DefaultLogger::dropped() const { return dispatch->dropped(); }
+
+std::shared_ptr<FrameRing> DefaultLogger::frameRing() {
+  if (auto r = ring.load(std::memory_order_acquire))
+    return r;
+
+  std::lock_guard lock(ring_mutex);
+  if (auto r = ring.load(std::memory_order_relaxed))
+    return r;
+  try {
+    auto r = std::make_shared<FrameRing>(ringFile(), ring_size);
+    ring.store(r, std::memory_order_release);
+    return r;
+  }
+  catch (const std::exception&) {
+    return nullptr;
+  }
+}
+
+std::filesystem::path DefaultLogger::ringFile() const {
+  return p / "images" / (std::string(name()) + ".ring");
+}
+
+void DefaultLogger::updateRing(const std::optional<ImageRing>& image_ring) {
+  std::lock_guard lock(ring_mutex);
+  if (image_ring)
+    ring_size = image_ring->bytes;
+
+  auto current = ring.load(std::memory_order_relaxed);
+  if (current && (current->path() != ringFile() ||
+                  current->capacity() != FrameRing::ringCapacity(ring_size)))
+    ring.store(nullptr, std::memory_order_release);
+}
 
 }  // namespace cvs::logger
 
 namespace cvs::logger {
 
+void DefaultLoggerFactory::LogConf::set(const Config::Option& option) {
+  std::visit(
+      [this](const auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, Level>)
+          level = value;
+        else if constexpr (std::is_same_v<T, Config::PatternOption>) {
+          pattern   = value.text;
+          time_type = value.time_type;
+        } else if constexpr (std::is_same_v<T, std::filesystem::path>)
+          path = value;
+        else if constexpr (std::is_same_v<T, Sinks>)
+          sinks = value;
+        else if constexpr (std::is_same_v<T, LogImage>)
+          log_image = value;
+        else if constexpr (std::is_same_v<T, Async>)
+          async = value;
+        else if constexpr (std::is_same_v<T, ImageRing>)
+          image_ring = value;
+        else if constexpr (std::is_same_v<T, Backend>)
+          backend = value;
+        else if constexpr (std::is_same_v<T, LogFile>)
+          log_file = value;
+        else if constexpr (std::is_same_v<T, Dedup>)
+          dedup = value;
+        else if constexpr (std::is_same_v<T, Recorder>)
+          recorder = value;
+      },
+      option);
+}
+
+void DefaultLoggerFactory::LogConf::merge(const LogConf& other) {
+  auto take = [](auto& to, const auto& from) {
+    if (from)
+      to = from;
+  };
+  take(level, other.level);
+  take(pattern, other.pattern);
+  take(time_type, other.time_type);
+  take(path, other.path);
+  take(sinks, other.sinks);
+  take(log_image, other.log_image);
+  take(async, other.async);
+  take(image_ring, other.image_ring);
+  take(backend, other.backend);
+  take(log_file, other.log_file);
+  take(dedup, other.dedup);
+  take(recorder, other.recorder);
+}
+
+DefaultLoggerFactory::Rule& DefaultLoggerFactory::rule(const std::string& pattern) {
+  auto [iter, inserted] = config_cache.try_emplace(pattern, pattern);
+  if (inserted)
+    rule_index.insert(iter->second.matcher, &*iter);
+  return iter->second;
+}
+
 void DefaultLoggerFactory::configureImpl(Regex ptrn, std::any val) {
   std::unique_lock lock(mutex);
 
-  std::string re_ptrn{ptrn};
+  auto& config = rule(std::string(ptrn)).config;
 
   if (val.type() == typeid(Level))
-    config_cache[re_ptrn].level = std::any_cast<Level>(val);
+    config.set(std::any_cast<Level>(val));
   else if (val.type() == typeid(Pattern)) {
-    auto p                          = std::any_cast<Pattern>(val);
-    config_cache[re_ptrn].pattern   = p;
-    config_cache[re_ptrn].time_type = p.time_type;
+    auto p = std::any_cast<Pattern>(val);
+    config.set(Config::PatternOption{std::string(p), p.time_type});
   } else if (val.type() == typeid(std::filesystem::path))
-    config_cache[re_ptrn].path = std::any_cast<std::filesystem::path>(val);
+    config.set(std::any_cast<std::filesystem::path>(val));
   else if (val.type() == typeid(Sinks))
-    config_cache[re_ptrn].sinks = std::any_cast<Sinks>(val);
+    config.set(std::any_cast<Sinks>(val));
   else if (val.type() == typeid(LogImage))
-    config_cache[re_ptrn].log_image = std::any_cast<LogImage>(val);
+    config.set(std::any_cast<LogImage>(val));
+  else if (val.type() == typeid(Async))
+    config.set(std::any_cast<Async>(val));
+  else if (val.type() == typeid(ImageRing))
+    config.set(std::any_cast<ImageRing>(val));
+  else if (val.type() == typeid(Backend))
+    config.set(std::any_cast<Backend>(val));
+  else if (val.type() == typeid(LogFile))
+    config.set(std::any_cast<LogFile>(val));
+  else if (val.type() == typeid(Dedup))
+    config.set(std::any_cast<Dedup>(val));
+  else if (val.type() == typeid(Recorder))
+    config.set(std::any_cast<Recorder>(val));
 }
 
 void DefaultLoggerFactory::configureImpl() {
+  std::lock_guard  create_lock(create_mutex);
   std::shared_lock lock(mutex);
 
-  for (auto& cfg : config_cache) {
-    std::regex re(cfg.first);
-    for (auto& logger : created_loggers) {
-      if (std::regex_match(logger.first, re)) {
-        configureLogger(logger.second, cfg.second);
-      }
-    }
+  created_loggers.forEach(
+      [this](const std::string& name, const LoggerPtr& logger) { applyRules(name, logger); });
+}
+
+void DefaultLoggerFactory::configureImpl(const Config& batch) {
+  std::lock_guard  create_lock(create_mutex);
+  std::unique_lock lock(mutex);
+
+  std::vector<const Rule*> changed;
+  for (auto& r : batch.rules()) {
+    auto& entry = rule(r.regex ? r.name : logNameToRegexPattern(r.name));
+    auto  old   = entry.config;
+    for (auto& option : r.options)
+      entry.config.set(option);
+    if (entry.config != old && std::find(changed.begin(), changed.end(), &entry) == changed.end())
+      changed.push_back(&entry);
   }
+  if (changed.empty())
+    return;
+
+  // Loggers that don't match a changed rule keep their configuration.
+  created_loggers.forEach([&](const std::string& name, const LoggerPtr& logger) {
+    if (std::any_of(changed.begin(), changed.end(),
+                    [&name](const Rule* r) { return r->matcher.match(name); }))
+      applyRules(name, logger);
+  });
+}
+
+void DefaultLoggerFactory::applyRules(const std::string& name, const LoggerPtr& logger) const {
+  std::vector<const RuleEntry*> rules;
+  rule_index.find(name, [&](const RuleEntry* rule) { rules.push_back(rule); });
+  if (rules.empty())
+    return;
+
+  // Matching rules are merged in the order of config_cache, so later patterns take precedence.
+  std::sort(rules.begin(), rules.end(),
+            [](const RuleEntry* r0, const RuleEntry* r1) { return r0->first < r1->first; });
+  LogConf config;
+  for (auto rule : rules)
+    config.merge(rule->second.config);
+  configureLogger(logger, config);
 }
 
 void DefaultLoggerFactory::configureLogger(const LoggerPtr& logger, const LogConf& config) const {
@@ -114,22 +275,34 @@ void DefaultLoggerFactory::configureLogger(const LoggerPtr& logger, const LogCon
   if (def_logger) {
     if (config.level)
       def_logger->logger->set_level(DefaultLogger::convertLogLevel(config.level.value()));
+    if (config.recorder)
+      def_logger->setRecorder(config.recorder.value());
+    // Setting a pattern rebuilds the formatters of all sinks, so an unchanged one is skipped.
     if (config.pattern) {
-      if (config.time_type)
-        def_logger->logger->set_pattern(config.pattern.value(),
-                                        convertTimeType(config.time_type.value()));
-      else
-        def_logger->logger->set_pattern(config.pattern.value());
+      auto time_type = config.time_type.value_or(TimeType::local);
+      if (config.pattern != def_logger->pattern || time_type != def_logger->time_type) {
+        def_logger->logger->set_pattern(config.pattern.value(), convertTimeType(time_type));
+        def_logger->pattern   = config.pattern;
+        def_logger->time_type = time_type;
+      }
     }
 
-    def_logger->p = config.path;
+    if (config.path) {
+      def_logger->p = config.path.value();
+      def_logger->file_sink->setPath(config.path.value());
+      def_logger->updateBinaryLog();
+    }
+    if (config.log_file)
+      def_logger->file_sink->setOptions(config.log_file.value());
 
     if (config.log_image)
       def_logger->log_image = config.log_image.value();
 
+    def_logger->updateRing(config.image_ring);
+
     if (config.sinks) {
       auto sinks_flags = config.sinks.value();
-      auto sinks       = def_logger->logger->sinks();
+      auto& sinks      = def_logger->dispatch->sinks();
       for (auto& s : sinks) {
         auto std_sink = std::dynamic_pointer_cast<StdoutSink>(s);
         if (std_sink) {
@@ -143,8 +316,23 @@ void DefaultLoggerFactory::configureLogger(const LoggerPtr& logger, const LogCon
                                                            : spdlog::level::off);
           continue;
         }
+        auto file_sink = std::dynamic_pointer_cast<FileSink>(s);
+        if (file_sink) {
+          file_sink->set_level(sinks_flags & Sinks::FILE ? spdlog::level::trace
+                                                         : spdlog::level::off);
+          continue;
+        }
       }
     }
+
+    if (config.async)
+      def_logger->dispatch->setAsync(config.async.value());
+
+    if (config.dedup)
+      def_logger->dispatch->setDedup(config.dedup.value());
+
+    if (config.backend)
+      def_logger->setBackend(config.backend.value());
   }
 }
 
@@ -152,41 +340,54 @@ LoggerPtr DefaultLoggerFactory::createLogger(std::string name) const {
   std::vector<spdlog::sink_ptr> sinks;
   sinks.push_back(createSink<StdoutSink>(default_sinks & Sinks::STDOUT));
   sinks.push_back(createSink<SystemdSink>(default_sinks & Sinks::SYSTEMD));
+  auto file_sink = createSink<FileSink>(default_sinks & Sinks::FILE, name);
+  sinks.push_back(file_sink);
 
-  auto logger = std::make_shared<spdlog::logger>(name, std::begin(sinks), std::end(sinks));
+  auto counters = std::make_shared<StatCounters>();
+  auto dispatch = std::make_shared<DispatchSink>(std::move(sinks), counters);
+  auto logger   = std::make_shared<spdlog::logger>(name, dispatch);
   if (name == default_logger_name)
     spdlog::set_default_logger(logger);
   else
     spdlog::register_logger(logger);
 
-  return std::make_shared<DefaultLogger>(std::move(logger));
+  return std::make_shared<DefaultLogger>(std::move(logger), std::move(counters),
+                                         std::move(dispatch), std::move(file_sink));
 }
 
 LoggerPtr DefaultLoggerFactory::getLoggerImpl(std::string_view n) {
+  if (auto logger = created_loggers.find(n))
+    return logger;
+
+  std::lock_guard create_lock(create_mutex);
+  // Another thread may have created the logger while this one was waiting.
+  if (auto logger = created_loggers.find(n))
+    return logger;
+
   std::string name{n};
+  auto        logger = createLogger(name);
   {
     std::shared_lock lock(mutex);
-
-    if (auto iter = created_loggers.find(name); iter != created_loggers.end())
-      return iter->second;
+    applyRules(name, logger);
   }
 
-  LoggerPtr logger;
-  {
-    std::unique_lock lock(mutex);
+  // The logger is published only after it is configured. Loggers are never replaced, so the
+  // call-site caches stay valid.
+  created_loggers.insert(name, logger);
 
-    logger = createLogger(name);
-    created_loggers.emplace(name, logger);
-  }
+  return logger;
+}
 
-  std::shared_lock lock(mutex);
-  for (auto& cfg : config_cache) {
-    std::regex re(cfg.first);
-    if (std::regex_match(name, re))
-      configureLogger(logger, cfg.second);
-  }
+Stats DefaultLoggerFactory::statsImpl() {
+  std::lock_guard create_lock(create_mutex);
 
-  return logger;
+  Stats snapshot;
+  created_loggers.forEach([&snapshot](const std::string& name, const LoggerPtr& logger) {
+    auto stats = logger->stats();
+    snapshot.total += stats;
+    snapshot.loggers.emplace(name, stats);
+  });
+  return snapshot;
 }
 
 LoggerPtr DefaultLoggerFactory::defaultLoggerImpl() { return getLoggerImpl(default_logger_name); }
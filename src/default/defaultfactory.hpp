@@ -2,7 +2,11 @@
 
 #include <cvs/logger/loggerfactory.hpp>
 
+#include "loggerregistry.hpp"
+#include "namematcher.hpp"
+
 #include <map>
+#include <mutex>
 #include <optional>
 #include <shared_mutex>
 
@@ -10,31 +14,63 @@ namespace cvs::logger {
 
 class DefaultLoggerFactory : public LoggerFactory {
   struct LogConf {
-    std::optional<Level>       level;
-    std::optional<std::string> pattern;
-    std::optional<TimeType>    time_type;
-    std::filesystem::path      path = std::filesystem::temp_directory_path();
-    std::optional<Sinks>       sinks;
-    std::optional<LogImage>    log_image;
+    std::optional<Level>                 level;
+    std::optional<std::string>           pattern;
+    std::optional<TimeType>              time_type;
+    std::optional<std::filesystem::path> path;
+    std::optional<Sinks>                 sinks;
+    std::optional<LogImage>              log_image;
+    std::optional<Async>                 async;
+    std::optional<ImageRing>             image_ring;
+    std::optional<Backend>               backend;
+    std::optional<LogFile>               log_file;
+    std::optional<Dedup>                 dedup;
+    std::optional<Recorder>              recorder;
+
+    void set(const Config::Option&);
+    // Takes the options set in `other`.
+    void merge(const LogConf& other);
+
+    bool operator==(const LogConf&) const = default;
+  };
+
+  struct Rule {
+    explicit Rule(const std::string& pattern)
+        : matcher(pattern) {}
+
+    NamePattern matcher;
+    LogConf     config;
   };
 
+  using RuleEntry = std::pair<const std::string, Rule>;
+
  protected:
   void configureImpl(Regex, std::any) override;
   void configureImpl() override;
+  void configureImpl(const Config&) override;
 
   LoggerPtr getLoggerImpl(std::string_view) override;
   LoggerPtr defaultLoggerImpl() override;
 
   std::string logNameToRegexPattern(std::string_view) const override;
 
+  Stats statsImpl() override;
+
  protected:
   virtual LoggerPtr createLogger(std::string) const;
   virtual void      configureLogger(const LoggerPtr& logger, const LogConf& config) const;
 
  private:
-  std::map<std::string, LogConf>             config_cache;
-  std::unordered_map<std::string, LoggerPtr> created_loggers;
-  std::shared_mutex                          mutex;
+  Rule& rule(const std::string& pattern);
+  void  applyRules(const std::string& name, const LoggerPtr& logger) const;
+
+  std::map<std::string, Rule> config_cache;
+  NameIndex<const RuleEntry*> rule_index;
+  std::shared_mutex           mutex;
+
+  // Lookups don't lock. Creation and iteration are serialised by create_mutex, taken before mutex.
+  LoggerRegistry created_loggers;
+  std::mutex     create_mutex;
 };
 
 }  // namespace cvs::logger
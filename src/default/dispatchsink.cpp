@@ -0,0 +1,445 @@
+#include "dispatchsink.hpp"
+#include "../include/cvs/logger/ilogger.hpp"
+
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+// Makes the images of a message visible to the sinks on the current thread.
+class CurrentImages {
+ public:
+  explicit CurrentImages(std::vector<std::string>& message_images)
+      : images(message_images) {
+    cvs::logger::ILogger::messageImages().swap(images);
+  }
+  ~CurrentImages() { cvs::logger::ILogger::messageImages().swap(images); }
+
+ private:
+  std::vector<std::string>& images;
+};
+
+}  // namespace
+
+namespace cvs::logger {
+
+// Owning copy of a message and its images.
+struct DispatchSink::Message {
+  spdlog::details::log_msg_buffer msg;
+  std::vector<std::string>        images;
+};
+
+class DispatchSink::Worker {
+ public:
+  Worker(DispatchSink& owner, const Async& config)
+      : owner(owner)
+      , capacity(std::max<std::size_t>(config.queue_size, 1))
+      , overflow(config.overflow) {
+    for (std::size_t i = 0; i < config.threads; ++i)
+      threads.emplace_back([this]() { run(); });
+  }
+
+  ~Worker() {
+    {
+      std::lock_guard lock(mutex);
+      stop = true;
+    }
+    not_empty.notify_all();
+    not_full.notify_all();
+    for (auto& t : threads)
+      t.join();
+  }
+
+  void push(const spdlog::details::log_msg& msg, std::vector<std::string>&& images) {
+    std::unique_lock lock(mutex);
+    if (queue.size() >= capacity) {
+      switch (overflow) {
+        case Overflow::block:
+          not_full.wait(lock, [this]() { return queue.size() < capacity; });
+          break;
+        case Overflow::drop_oldest:
+          queue.pop_front();
+          ++owner.dropped_cnt;
+          break;
+        case Overflow::drop_newest: ++owner.dropped_cnt; return;
+      }
+    }
+    queue.push_back({spdlog::details::log_msg_buffer(msg), std::move(images)});
+    lock.unlock();
+    not_empty.notify_one();
+  }
+
+  void wait() {
+    std::unique_lock lock(mutex);
+    idle.wait(lock, [this]() { return queue.empty() && busy == 0; });
+  }
+
+ private:
+  void run() {
+    std::unique_lock lock(mutex);
+    while (true) {
+      not_empty.wait(lock, [this]() { return stop || !queue.empty(); });
+      // The queue is drained before the worker stops.
+      if (queue.empty())
+        return;
+
+      auto message = std::move(queue.front());
+      queue.pop_front();
+      ++busy;
+      lock.unlock();
+      not_full.notify_one();
+
+      try {
+        owner.sinkIt(message.msg, message.images);
+      }
+      catch (...) {
+        // A failing sink must not stop the worker.
+      }
+
+      lock.lock();
+      --busy;
+      if (queue.empty() && busy == 0)
+        idle.notify_all();
+    }
+  }
+
+  DispatchSink&     owner;
+  const std::size_t capacity;
+  const Overflow    overflow;
+
+  std::deque<Message> queue;
+  std::size_t         busy = 0;
+  bool                stop = false;
+
+  std::mutex               mutex;
+  std::condition_variable  not_empty, not_full, idle;
+  std::vector<std::thread> threads;
+};
+
+// The last message of a logger and the number of its repeats.
+class DispatchSink::Repeats {
+ public:
+  explicit Repeats(const Dedup& config)
+      : timeout(config.timeout) {}
+
+  std::mutex                mutex;
+  std::chrono::milliseconds timeout;
+
+  bool                      valid = false;
+  std::size_t               hash  = 0;
+  spdlog::level::level_enum level = spdlog::level::off;
+  std::string               payload;
+  std::string               logger_name;
+
+  std::size_t                   count = 0;
+  Clock::time_point             deadline;
+  spdlog::log_clock::time_point last_time;
+  std::string                   summary;
+
+  // Set while a thread dispatches, other threads hand their messages to it.
+  bool                    dispatching = false;
+  std::vector<Message>    handoff;
+  std::condition_variable dispatched;
+};
+
+// Writes the repeats counts of all sinks at their deadlines, so a count is not held back until
+// the logger writes something else.
+class DispatchSink::RepeatTimer {
+ public:
+  static std::shared_ptr<RepeatTimer> instance() {
+    static auto timer = std::make_shared<RepeatTimer>();
+    return timer;
+  }
+
+  RepeatTimer()
+      : thread([this]() { run(); }) {}
+
+  ~RepeatTimer() {
+    {
+      std::lock_guard lock(mutex);
+      stop = true;
+    }
+    cv.notify_one();
+    thread.join();
+  }
+
+  void add(DispatchSink* sink) {
+    std::lock_guard lock(mutex);
+    sinks.push_back(sink);
+  }
+
+  // Waits for the running check of the sink.
+  void remove(DispatchSink* sink) {
+    std::unique_lock lock(mutex);
+    sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+    checked.wait(lock, [this]() { return !checking; });
+  }
+
+  // A new deadline was set. Called without the locks of the sink.
+  void wake() {
+    {
+      std::lock_guard lock(mutex);
+      woken = true;
+    }
+    cv.notify_one();
+  }
+
+ private:
+  void run() {
+    std::vector<DispatchSink*> snapshot;
+    std::unique_lock           lock(mutex);
+    while (!stop) {
+      // The sinks write without the lock, so a blocked sink does not hold up wake() and add().
+      woken    = false;
+      checking = true;
+      snapshot = sinks;
+      lock.unlock();
+
+      auto next = Clock::time_point::max();
+      for (auto sink : snapshot)
+        next = std::min(next, sink->expireRepeats(Clock::now()));
+
+      lock.lock();
+      checking = false;
+      checked.notify_all();
+
+      auto pred = [this]() { return stop || woken; };
+      if (next == Clock::time_point::max())
+        cv.wait(lock, pred);
+      else
+        cv.wait_until(lock, next, pred);
+    }
+  }
+
+  std::mutex                 mutex;
+  std::condition_variable    cv;
+  std::condition_variable    checked;
+  std::vector<DispatchSink*> sinks;
+  bool                       woken    = false;
+  bool                       checking = false;
+  bool                       stop     = false;
+
+  std::thread thread;
+};
+
+DispatchSink::DispatchSink(std::vector<spdlog::sink_ptr> sinks,
+                           std::shared_ptr<StatCounters>  stat_counters)
+    : targets(std::move(sinks))
+    , counters(std::move(stat_counters)) {}
+
+DispatchSink::~DispatchSink() {
+  if (timer)
+    timer->remove(this);
+}
+
+void DispatchSink::log(const spdlog::details::log_msg& msg) {
+  std::vector<std::string> images;
+  images.swap(ILogger::messageImages());
+  {
+    std::shared_lock lock(mutex);
+    if (!repeats) {
+      dispatch(msg, std::move(images));
+      return;
+    }
+    if (!collapse(msg, std::move(images)))
+      return;
+  }
+  timer->wake();
+}
+
+void DispatchSink::flush() {
+  {
+    std::shared_lock lock(mutex);
+    if (repeats) {
+      std::unique_lock repeats_lock(repeats->mutex);
+      dispatchInOrder(repeats_lock, takeRepeats());
+      repeats->dispatched.wait(repeats_lock, [this]() { return !repeats->dispatching; });
+    }
+    if (worker)
+      worker->wait();
+  }
+  for (auto& s : targets)
+    s->flush();
+}
+
+void DispatchSink::set_pattern(const std::string& pattern) {
+  for (auto& s : targets)
+    s->set_pattern(pattern);
+}
+
+void DispatchSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter) {
+  for (auto& s : targets)
+    s->set_formatter(formatter->clone());
+}
+
+const std::vector<spdlog::sink_ptr>& DispatchSink::sinks() const { return targets; }
+
+void DispatchSink::setAsync(const Async& config) {
+  std::unique_lock lock(mutex);
+
+  if (config == async_config)
+    return;
+
+  // The old worker writes out its queue before it is destroyed.
+  worker.reset();
+  if (config.threads)
+    worker = std::make_unique<Worker>(*this, config);
+  async_config = config;
+}
+
+void DispatchSink::setDedup(const Dedup& config) {
+  // The timer is set before `repeats` is published, logging threads use it without the lock.
+  if (config.enable && !timer) {
+    timer = RepeatTimer::instance();
+    timer->add(this);
+  }
+
+  std::unique_lock lock(mutex);
+  if (!config.enable) {
+    if (repeats) {
+      std::unique_lock repeats_lock(repeats->mutex);
+      dispatchInOrder(repeats_lock, takeRepeats());
+    }
+    repeats.reset();
+    return;
+  }
+
+  if (repeats)
+    repeats->timeout = config.timeout;
+  else
+    repeats = std::make_unique<Repeats>(config);
+}
+
+std::size_t DispatchSink::dropped() const { return dropped_cnt.load(std::memory_order_relaxed); }
+
+void DispatchSink::dispatch(const spdlog::details::log_msg& msg,
+                            std::vector<std::string>&&      images) {
+  if (worker)
+    worker->push(msg, std::move(images));
+  else
+    sinkIt(msg, images);
+}
+
+bool DispatchSink::collapse(const spdlog::details::log_msg& msg,
+                            std::vector<std::string>&&      images) {
+  std::string_view payload(msg.payload.data(), msg.payload.size());
+  // Different messages almost always differ in the hash, the text is compared only if it matches.
+  auto hash = std::hash<std::string_view>{}(payload);
+
+  std::unique_lock lock(repeats->mutex);
+  auto&            last = *repeats;
+  if (last.valid && last.hash == hash && last.level == msg.level && last.payload == payload) {
+    last.last_time = msg.time;
+    if (last.count++ > 0)
+      return false;
+    last.deadline = Clock::now() + last.timeout;
+    return true;
+  }
+
+  auto summary = takeRepeats();
+  last.valid   = true;
+  last.hash    = hash;
+  last.level   = msg.level;
+  last.payload.assign(payload);
+  if (last.logger_name.empty())
+    last.logger_name.assign(msg.logger_name.data(), msg.logger_name.size());
+
+  // The count always precedes the next message.
+  dispatchInOrder(lock, std::move(summary), &msg, std::move(images));
+  return false;
+}
+
+std::optional<DispatchSink::Message> DispatchSink::takeRepeats() {
+  auto& last = *repeats;
+  if (last.count == 0)
+    return std::nullopt;
+
+  last.summary = fmt::format("last message repeated {} times", last.count);
+  last.count   = 0;
+  return Message{spdlog::details::log_msg_buffer(spdlog::details::log_msg(
+                     last.last_time, spdlog::source_loc{}, last.logger_name, last.level,
+                     last.summary)),
+                 {}};
+}
+
+void DispatchSink::dispatchInOrder(std::unique_lock<std::mutex>&   lock,
+                                   std::optional<Message>          summary,
+                                   const spdlog::details::log_msg* msg,
+                                   std::vector<std::string>&&      images) {
+  auto& r = *repeats;
+  if (r.dispatching) {
+    if (summary)
+      r.handoff.push_back(std::move(*summary));
+    if (msg)
+      r.handoff.push_back({spdlog::details::log_msg_buffer(*msg), std::move(images)});
+    return;
+  }
+  if (!summary && !msg)
+    return;
+
+  r.dispatching = true;
+  lock.unlock();
+  try {
+    if (summary)
+      dispatch(summary->msg, std::move(summary->images));
+    if (msg)
+      dispatch(*msg, std::move(images));
+
+    lock.lock();
+    while (!r.handoff.empty()) {
+      auto messages = std::move(r.handoff);
+      r.handoff.clear();
+      lock.unlock();
+      for (auto& m : messages)
+        dispatch(m.msg, std::move(m.images));
+      lock.lock();
+    }
+  }
+  catch (...) {
+    // The messages handed off meanwhile are written by the next dispatching thread.
+    if (!lock.owns_lock())
+      lock.lock();
+    r.dispatching = false;
+    r.dispatched.notify_all();
+    throw;
+  }
+  r.dispatching = false;
+  r.dispatched.notify_all();
+}
+
+DispatchSink::Clock::time_point DispatchSink::expireRepeats(Clock::time_point now) {
+  std::shared_lock lock(mutex);
+  if (!repeats)
+    return Clock::time_point::max();
+
+  std::unique_lock repeats_lock(repeats->mutex);
+  if (repeats->count == 0)
+    return Clock::time_point::max();
+  if (now < repeats->deadline)
+    return repeats->deadline;
+  dispatchInOrder(repeats_lock, takeRepeats());
+  return Clock::time_point::max();
+}
+
+void DispatchSink::sinkIt(const spdlog::details::log_msg& msg, std::vector<std::string>& images) {
+  counters->emitted(msg.payload.size());
+  CurrentImages current(images);
+  bool          sample = counters->sampleSinkTime();
+  auto          start  = sample ? Clock::now() : Clock::time_point{};
+  for (auto& s : targets) {
+    if (s->should_log(msg.level))
+      s->log(msg);
+  }
+  if (sample)
+    counters->sinkTime(Clock::now() - start);
+}
+
+}  // namespace cvs::logger
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cvs/logger/configtypes.hpp>
+#include <cvs/logger/stats.hpp>
+
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace cvs::logger {
+
+/**
+ * The only sink of a DefaultLogger. Passes messages to the real sinks on the caller's thread or,
+ * in asynchronous mode, through a bounded queue served by background workers. With Dedup the
+ * repeats of the last message are counted before they reach the queue. Counts the emitted messages
+ * and samples the time spent in the sinks for the statistics of the logger. The images of a message
+ * (see ILogger::messageImages) are passed along with it to the thread that runs the sinks.
+ */
+class DispatchSink : public spdlog::sinks::sink {
+  struct Message;
+  class Worker;
+  class Repeats;
+  class RepeatTimer;
+
+  using Clock = std::chrono::steady_clock;
+
+ public:
+  DispatchSink(std::vector<spdlog::sink_ptr>, std::shared_ptr<StatCounters>);
+  ~DispatchSink() override;
+
+  void log(const spdlog::details::log_msg&) override;
+  void flush() override;
+  void set_pattern(const std::string&) override;
+  void set_formatter(std::unique_ptr<spdlog::formatter>) override;
+
+  const std::vector<spdlog::sink_ptr>& sinks() const;
+
+  void        setAsync(const Async&);
+  void        setDedup(const Dedup&);
+  std::size_t dropped() const;
+
+ private:
+  // Passes the message to the worker or to the sinks. Requires `mutex`.
+  void dispatch(const spdlog::details::log_msg&, std::vector<std::string>&& images = {});
+  // Returns true if the message is the first repeat of the last one. Requires `mutex`.
+  bool collapse(const spdlog::details::log_msg&, std::vector<std::string>&& images);
+  // Takes the pending repeats count as a message. Requires `mutex` and the lock of `repeats`.
+  std::optional<Message> takeRepeats();
+  /**
+   * Dispatches the summary and the message, if any, after releasing the held `lock` of `repeats`,
+   * or hands them to the thread dispatching already, so messages are written in the order they
+   * were collapsed. Returns with `lock` held. Requires `mutex`.
+   */
+  void dispatchInOrder(std::unique_lock<std::mutex>&   lock,
+                       std::optional<Message>          summary,
+                       const spdlog::details::log_msg* msg    = nullptr,
+                       std::vector<std::string>&&      images = {});
+  // Writes the counts due by `now` and returns the next deadline.
+  Clock::time_point expireRepeats(Clock::time_point now);
+
+  void sinkIt(const spdlog::details::log_msg&, std::vector<std::string>& images);
+
+  const std::vector<spdlog::sink_ptr> targets;
+  const std::shared_ptr<StatCounters> counters;
+
+  std::unique_ptr<Worker>      worker;
+  std::unique_ptr<Repeats>     repeats;
+  std::shared_ptr<RepeatTimer> timer;
+  Async                   async_config{0, Overflow::block, 0};
+  std::atomic_size_t      dropped_cnt{0};
+  std::shared_mutex       mutex;
+};
+
+}  // namespace cvs::logger
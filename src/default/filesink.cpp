@@ -0,0 +1,340 @@
+#include "filesink.hpp"
+#include "segmentcompressor.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::size_t pageSize() {
+  static const auto size = std::size_t(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+[[noreturn]] void throwError(const std::string& what, const std::filesystem::path& file) {
+  throw std::system_error(errno, std::generic_category(), what + " " + file.string());
+}
+
+}  // namespace
+
+namespace cvs::logger {
+
+// Writes the buffers of all file sinks at the latest their flush interval after the oldest
+// buffered message, so a quiet logger does not hold its messages back.
+class FileSink::FlushTimer {
+ public:
+  static std::shared_ptr<FlushTimer> instance() {
+    static auto timer = std::make_shared<FlushTimer>();
+    return timer;
+  }
+
+  FlushTimer()
+      : thread([this]() { run(); }) {}
+
+  ~FlushTimer() {
+    {
+      std::lock_guard lock(mutex);
+      stop = true;
+    }
+    cv.notify_one();
+    thread.join();
+  }
+
+  void add(FileSink* sink) {
+    std::lock_guard lock(mutex);
+    sinks.push_back(sink);
+  }
+
+  // Waits for the running check of the sink.
+  void remove(FileSink* sink) {
+    std::unique_lock lock(mutex);
+    sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+    checked.wait(lock, [this]() { return !checking; });
+  }
+
+  // A new deadline was set.
+  void wake() {
+    {
+      std::lock_guard lock(mutex);
+      woken = true;
+    }
+    cv.notify_one();
+  }
+
+ private:
+  void run() {
+    std::vector<FileSink*> snapshot;
+    std::unique_lock       lock(mutex);
+    while (!stop) {
+      // The sinks are locked while they write, so they are checked without the timer lock.
+      woken    = false;
+      checking = true;
+      snapshot = sinks;
+      lock.unlock();
+
+      auto next = Clock::time_point::max();
+      for (auto sink : snapshot)
+        next = std::min(next, sink->expireBuffer(Clock::now()));
+
+      lock.lock();
+      checking = false;
+      checked.notify_all();
+
+      auto pred = [this]() { return stop || woken; };
+      if (next == Clock::time_point::max())
+        cv.wait(lock, pred);
+      else
+        cv.wait_until(lock, next, pred);
+    }
+  }
+
+  std::mutex              mutex;
+  std::condition_variable cv;
+  std::condition_variable checked;
+  std::vector<FileSink*>  sinks;
+  bool                    woken    = false;
+  bool                    checking = false;
+  bool                    stop     = false;
+
+  std::thread thread;
+};
+
+FileSink::FileSink(std::string n)
+    : name(std::move(n)) {}
+
+FileSink::~FileSink() {
+  if (timer)
+    timer->remove(this);
+  try {
+    std::lock_guard lock(mutex_);
+    close();
+  }
+  catch (...) {
+  }
+}
+
+void FileSink::setPath(const std::filesystem::path& path) {
+  std::lock_guard lock(mutex_);
+  if (path == dir)
+    return;
+  close();
+  dir = path;
+}
+
+void FileSink::setOptions(const LogFile& opts) {
+  std::lock_guard lock(mutex_);
+  if (opts.mmap != options.mmap || opts.buffer_size != options.buffer_size)
+    close();
+  options = opts;
+}
+
+void FileSink::sink_it_(const spdlog::details::log_msg& msg) {
+  spdlog::memory_buf_t formatted;
+  formatter_->format(msg, formatted);
+
+  if (fd >= 0) {
+    bool too_big = options.max_size != 0 && file_size != 0 &&
+                   file_size + formatted.size() > options.max_size;
+    bool too_old = options.max_age.count() != 0 && msg.time - opened >= options.max_age;
+    if (too_big || too_old)
+      rotate();
+  }
+  if (fd < 0)
+    open();
+
+  append(formatted.data(), formatted.size());
+
+  // Level mirrors the spdlog levels.
+  if (msg.level >= static_cast<spdlog::level::level_enum>(options.flush_level))
+    flush_();
+}
+
+void FileSink::flush_() {
+  // Data written to the mapping is already in the page cache.
+  if (fd >= 0 && !options.mmap)
+    writeBuffer(fd);
+}
+
+std::filesystem::path FileSink::file() const { return dir / (name + ".log"); }
+
+std::filesystem::path FileSink::rotatedFile() const {
+  auto time = std::chrono::system_clock::to_time_t(opened);
+  auto ms   = std::chrono::duration_cast<std::chrono::milliseconds>(opened.time_since_epoch());
+
+  std::tm tm;
+  ::localtime_r(&time, &tm);
+  char stamp[32];
+  auto len = std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+  std::snprintf(stamp + len, sizeof(stamp) - len, "-%03d", int(ms.count() % 1000));
+
+  // Start times sort the segments chronologically, a counter resolves collisions.
+  auto rotated = dir / (name + "." + stamp + ".log");
+  for (int i = 1; std::filesystem::exists(rotated); ++i)
+    rotated = dir / (name + "." + stamp + "." + std::to_string(i) + ".log");
+  return rotated;
+}
+
+void FileSink::open() {
+  auto path = file();
+  std::filesystem::create_directories(dir);
+
+  int flags = options.mmap ? O_RDWR : O_WRONLY | O_APPEND;
+  fd        = ::open(path.c_str(), flags | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throwError("Can't open", path);
+
+  struct stat st {};
+  ::fstat(fd, &st);
+  file_size = std::size_t(st.st_size);
+  opened    = std::chrono::system_clock::now();
+
+  if (options.mmap) {
+    window_size = std::max(options.buffer_size, pageSize()) / pageSize() * pageSize();
+    try {
+      mapWindow(file_size / window_size * window_size);
+    }
+    catch (...) {
+      close();
+      throw;
+    }
+  } else {
+    buffer.reserve(options.buffer_size);
+  }
+}
+
+void FileSink::close() {
+  if (fd < 0)
+    return;
+
+  if (options.mmap) {
+    if (window)
+      ::munmap(window, window_size);
+    window = nullptr;
+    // Drop the preallocated tail.
+    ::ftruncate(fd, off_t(file_size));
+    ::close(fd);
+    fd = -1;
+    return;
+  }
+
+  int out = std::exchange(fd, -1);
+  try {
+    writeBuffer(out);
+  }
+  catch (...) {
+    ::close(out);
+    throw;
+  }
+  ::close(out);
+}
+
+void FileSink::rotate() {
+  close();
+  std::error_code ec;
+  std::filesystem::rename(file(), rotatedFile(), ec);
+  if (!ec && (options.compress || options.retention != 0))
+    SegmentCompressor::instance().schedule(dir, name, options.compress, options.retention);
+}
+
+void FileSink::append(const char* data, std::size_t size) {
+  if (!options.mmap) {
+    bool first = buffer.size() == 0;
+    buffer.append(data, data + size);
+    file_size += size;
+    if (buffer.size() >= options.buffer_size)
+      writeBuffer(fd);
+    else if (first && options.flush_interval.count() > 0) {
+      flush_deadline = Clock::now() + options.flush_interval;
+      if (!timer) {
+        timer = FlushTimer::instance();
+        timer->add(this);
+      }
+      timer->wake();
+    }
+    return;
+  }
+
+  while (size > 0) {
+    auto pos = file_size - window_offset;
+    if (pos == window_size) {
+      try {
+        mapWindow(window_offset + window_size);
+      }
+      catch (...) {
+        close();
+        throw;
+      }
+      pos = 0;
+    }
+    auto chunk = std::min(size, window_size - pos);
+    std::memcpy(window + pos, data, chunk);
+    data += chunk;
+    size -= chunk;
+    file_size += chunk;
+  }
+}
+
+void FileSink::writeBuffer(int out) {
+  const char* data = buffer.data();
+  std::size_t size = buffer.size();
+  while (size > 0) {
+    auto written = ::write(out, data, size);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      buffer.clear();
+      throwError("Can't write", file());
+    }
+    data += written;
+    size -= std::size_t(written);
+  }
+  buffer.clear();
+}
+
+FileSink::Clock::time_point FileSink::expireBuffer(Clock::time_point now) {
+  std::lock_guard lock(mutex_);
+  if (fd < 0 || options.mmap || buffer.size() == 0 || options.flush_interval.count() <= 0)
+    return Clock::time_point::max();
+  if (now < flush_deadline)
+    return flush_deadline;
+  // The timer has no logger to report to, the next write of the sink fails the same way.
+  try {
+    writeBuffer(fd);
+  }
+  catch (const std::system_error&) {
+  }
+  return Clock::time_point::max();
+}
+
+void FileSink::mapWindow(std::size_t offset) {
+  if (window) {
+    ::munmap(window, window_size);
+    window = nullptr;
+  }
+  // Allocate the blocks first, a write to a mapping beyond a full disk would raise SIGBUS.
+  if (int err = ::posix_fallocate(fd, off_t(offset), off_t(window_size)); err != 0) {
+    errno = err;
+    throwError("Can't allocate", file());
+  }
+  void* addr =
+      ::mmap(nullptr, window_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, off_t(offset));
+  if (addr == MAP_FAILED)
+    throwError("Can't map", file());
+
+  window        = static_cast<char*>(addr);
+  window_offset = offset;
+}
+
+}  // namespace cvs::logger
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cvs/logger/configtypes.hpp>
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace cvs::logger {
+
+/**
+ * Sink of Sinks::FILE, see LogFile. The file is opened on the first message, so loggers with the
+ * sink disabled don't create files.
+ */
+class FileSink : public spdlog::sinks::base_sink<std::mutex> {
+  class FlushTimer;
+
+  using Clock = std::chrono::steady_clock;
+
+ public:
+  explicit FileSink(std::string name);
+  ~FileSink() override;
+
+  // The current segment is closed when the directory or the write mode changes.
+  void setPath(const std::filesystem::path&);
+  void setOptions(const LogFile&);
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg&) override;
+  void flush_() override;
+
+ private:
+  std::filesystem::path file() const;
+  std::filesystem::path rotatedFile() const;
+
+  void open();
+  void close();
+  void rotate();
+  void append(const char* data, std::size_t size);
+  void writeBuffer(int out);
+  void mapWindow(std::size_t offset);
+  // Writes the buffer if its flush interval passed, returns when it is due otherwise.
+  Clock::time_point expireBuffer(Clock::time_point now);
+
+  const std::string     name;
+  std::filesystem::path dir = std::filesystem::temp_directory_path();
+  LogFile               options;
+
+  int                                   fd        = -1;
+  std::size_t                           file_size = 0;
+  std::chrono::system_clock::time_point opened;
+
+  spdlog::memory_buf_t buffer;
+  Clock::time_point    flush_deadline;  // Of the oldest message in the buffer.
+
+  std::shared_ptr<FlushTimer> timer;
+
+  // Mapped part of the file in mmap mode.
+  char*       window        = nullptr;
+  std::size_t window_offset = 0;
+  std::size_t window_size   = 0;
+};
+
+}  // namespace cvs::logger
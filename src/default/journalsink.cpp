@@ -0,0 +1,204 @@
+#include "journalsink.hpp"
+#include "../include/cvs/logger/ilogger.hpp"
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/fmt/fmt.h>
+#include <systemd/sd-journal.h>
+#include <sys/uio.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Syslog priorities of the spdlog levels, the same as in spdlog::sinks::systemd_sink.
+constexpr std::array<std::string_view, 7> priorities = {"7", "7", "6", "4", "3", "2", "6"};
+
+// Fields of one journal entry, stored back to back.
+struct Entry {
+  std::string              data;
+  std::vector<std::size_t> ends;
+
+  void add(std::string_view key, std::string_view value) {
+    data.append(key);
+    data.push_back('=');
+    data.append(value);
+    ends.push_back(data.size());
+  }
+
+  void add(std::string_view key, std::uint64_t value) {
+    fmt::format_int number(value);
+    add(key, std::string_view(number.data(), number.size()));
+  }
+};
+
+}  // namespace
+
+namespace cvs::logger {
+
+class JournalQueue {
+ public:
+  static constexpr std::size_t capacity = 8192;
+
+  static std::shared_ptr<JournalQueue> instance() {
+    static auto queue = std::make_shared<JournalQueue>();
+    return queue;
+  }
+
+  ~JournalQueue() {
+    {
+      std::lock_guard lock(mutex);
+      stop = true;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+      thread.join();
+  }
+
+  void push(const spdlog::details::log_msg& msg);
+
+  void flush() {
+    std::unique_lock lock(mutex);
+    idle.wait(lock, [this] { return queued == 0 && !sending; });
+  }
+
+  std::size_t dropped() const { return dropped_cnt.load(std::memory_order_relaxed); }
+
+ private:
+  void run();
+  void send(const Entry&);
+
+  std::mutex              mutex;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  std::vector<Entry>      queue;
+  std::size_t             queued  = 0;
+  bool                    sending = false;
+  bool                    stop    = false;
+
+  std::atomic_size_t dropped_cnt{0};
+
+  // Started by the first message. Used by the sending thread only.
+  std::vector<Entry> batch;
+  std::vector<iovec> fields;
+  std::size_t        reported_drops = 0;
+
+  std::thread thread;
+};
+
+void JournalQueue::push(const spdlog::details::log_msg& msg) {
+  // The entry is rendered without the lock shared by all loggers. Its buffers are swapped with the
+  // queue slot, so a warm thread renders without allocations.
+  thread_local Entry entry;
+  entry.data.clear();
+  entry.ends.clear();
+
+  std::string_view payload(msg.payload.data(), msg.payload.size());
+  std::string_view name(msg.logger_name.data(), msg.logger_name.size());
+  auto             level = spdlog::level::to_string_view(msg.level);
+
+  entry.add("MESSAGE", payload);
+  entry.add("PRIORITY", priorities[std::size_t(msg.level)]);
+  entry.add("SYSLOG_IDENTIFIER", name);
+  entry.add("CVS_LOGGER", name);
+  entry.add("CVS_LEVEL", std::string_view(level.data(), level.size()));
+  entry.add("TID", std::uint64_t(msg.thread_id));
+  if (!msg.source.empty()) {
+    entry.add("CODE_FILE", msg.source.filename);
+    entry.add("CODE_LINE", std::uint64_t(msg.source.line));
+    if (msg.source.funcname)
+      entry.add("CODE_FUNC", msg.source.funcname);
+  }
+  for (auto& image : ILogger::messageImages())
+    entry.add("CVS_IMAGE", image);
+
+  std::unique_lock lock(mutex);
+  if (queued >= capacity) {
+    dropped_cnt.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  if (queued == queue.size())
+    queue.emplace_back();
+  std::swap(queue[queued++], entry);
+
+  if (!thread.joinable())
+    thread = std::thread([this] { run(); });
+
+  bool wake_sender = queued == 1 && !sending;
+  lock.unlock();
+  if (wake_sender)
+    wake.notify_one();
+}
+
+void JournalQueue::run() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    wake.wait(lock, [this] { return stop || queued > 0; });
+    // The queue is drained before exit.
+    if (queued == 0)
+      break;
+
+    auto count = std::exchange(queued, 0);
+    std::swap(queue, batch);
+    sending = true;
+    lock.unlock();
+
+    for (std::size_t i = 0; i < count; ++i)
+      send(batch[i]);
+
+    auto drops = dropped_cnt.load(std::memory_order_relaxed);
+    if (drops != reported_drops) {
+      Entry notice;
+      notice.add("MESSAGE",
+                 std::to_string(drops - reported_drops) + " messages dropped by the journal queue");
+      notice.add("PRIORITY", priorities[spdlog::level::warn]);
+      send(notice);
+      reported_drops = drops;
+    }
+
+    lock.lock();
+    sending = false;
+    if (queued == 0)
+      idle.notify_all();
+  }
+}
+
+void JournalQueue::send(const Entry& entry) {
+  fields.resize(entry.ends.size());
+  std::size_t begin = 0;
+  for (std::size_t i = 0; i < fields.size(); ++i) {
+    fields[i].iov_base = const_cast<char*>(entry.data.data() + begin);
+    fields[i].iov_len  = entry.ends[i] - begin;
+    begin              = entry.ends[i];
+  }
+  // Errors are not reported, there is no caller to report them to.
+  sd_journal_sendv(fields.data(), int(fields.size()));
+}
+
+JournalSink::JournalSink()
+    : queue(JournalQueue::instance()) {}
+
+JournalSink::~JournalSink() = default;
+
+void JournalSink::log(const spdlog::details::log_msg& msg) {
+  if (should_log(msg.level))
+    queue->push(msg);
+}
+
+void JournalSink::flush() { queue->flush(); }
+
+void JournalSink::set_pattern(const std::string&) {}
+
+void JournalSink::set_formatter(std::unique_ptr<spdlog::formatter>) {}
+
+std::size_t JournalSink::dropped() const { return queue->dropped(); }
+
+}  // namespace cvs::logger
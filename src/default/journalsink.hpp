@@ -0,0 +1,40 @@
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+
+#include <memory>
+#include <string>
+
+namespace cvs::logger {
+
+class JournalQueue;
+
+/**
+ * Thread-safe journald sink. Logging threads only render the journal fields of a message into a
+ * bounded queue shared by all loggers. A background thread takes the queue as a batch and sends
+ * its entries with sd_journal_sendv. Besides MESSAGE, PRIORITY and SYSLOG_IDENTIFIER every entry
+ * has the fields CVS_LOGGER, CVS_LEVEL, TID, CODE_FILE, CODE_LINE and CODE_FUNC when the call site
+ * is known and CVS_IMAGE for every saved image of the message, so `journalctl
+ * CVS_LOGGER=camera.front` filters without parsing the text. The pattern is ignored, the journal
+ * keeps the metadata in its own fields.
+ */
+class JournalSink : public spdlog::sinks::sink {
+ public:
+  JournalSink();
+  ~JournalSink() override;
+
+  void log(const spdlog::details::log_msg&) override;
+  // Waits until the queued entries are sent.
+  void flush() override;
+  void set_pattern(const std::string&) override;
+  void set_formatter(std::unique_ptr<spdlog::formatter>) override;
+
+  // Messages of all loggers lost because the queue was full.
+  std::size_t dropped() const;
+
+ private:
+  // Shared by all sinks, the last one sends the remaining entries on destruction.
+  std::shared_ptr<JournalQueue> queue;
+};
+
+}  // namespace cvs::logger
@@ -0,0 +1,65 @@
+#include "loggerregistry.hpp"
+
+#include <functional>
+
+namespace {
+
+constexpr std::size_t initial_capacity = 64;
+
+}  // namespace
+
+namespace cvs::logger {
+
+LoggerRegistry::Table::Table(std::size_t capacity)
+    : mask(capacity - 1)
+    , slots(new std::atomic<const Entry*>[capacity]) {
+  for (std::size_t i = 0; i < capacity; ++i)
+    slots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+void LoggerRegistry::Table::place(const Entry* entry) {
+  auto i = entry->hash & mask;
+  while (slots[i].load(std::memory_order_relaxed))
+    i = (i + 1) & mask;
+  slots[i].store(entry, std::memory_order_release);
+  ++size;
+}
+
+LoggerRegistry::LoggerRegistry() {
+  tables.push_back(std::make_unique<Table>(initial_capacity));
+  table.store(tables.back().get(), std::memory_order_release);
+}
+
+LoggerRegistry::~LoggerRegistry() = default;
+
+LoggerPtr LoggerRegistry::find(std::string_view name) const {
+  const auto hash = std::hash<std::string_view>{}(name);
+  const auto t    = table.load(std::memory_order_acquire);
+  // The load factor stays below 1/2, so the probe always reaches an empty slot.
+  for (auto i = hash & t->mask;; i = (i + 1) & t->mask) {
+    auto entry = t->slots[i].load(std::memory_order_acquire);
+    if (!entry)
+      return nullptr;
+    if (entry->hash == hash && entry->name == name)
+      return entry->logger;
+  }
+}
+
+void LoggerRegistry::insert(std::string name, LoggerPtr logger) {
+  const auto hash = std::hash<std::string_view>{}(name);
+  entries.push_back(std::make_unique<Entry>(Entry{std::move(name), std::move(logger), hash}));
+
+  auto current = tables.back().get();
+  if ((current->size + 1) * 2 <= current->mask + 1) {
+    current->place(entries.back().get());
+    return;
+  }
+
+  auto grown = std::make_unique<Table>((current->mask + 1) * 2);
+  for (auto& entry : entries)
+    grown->place(entry.get());
+  table.store(grown.get(), std::memory_order_release);
+  tables.push_back(std::move(grown));
+}
+
+}  // namespace cvs::logger
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cvs/logger/loggerfactory.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cvs::logger {
+
+/**
+ * Append-only map of created loggers. find() reads an open-addressing table of immutable entries
+ * without locks or waiting. Inserts must be serialised by the owner. A grown table is published
+ * as a whole, and the replaced tables are kept until the registry is destroyed, because readers
+ * may still hold them.
+ */
+class LoggerRegistry {
+ public:
+  LoggerRegistry();
+  ~LoggerRegistry();
+
+  LoggerRegistry(const LoggerRegistry&) = delete;
+  LoggerRegistry& operator=(const LoggerRegistry&) = delete;
+
+  LoggerPtr find(std::string_view name) const;
+  void      insert(std::string name, LoggerPtr logger);
+
+  // Visits loggers in creation order. Must not run concurrently with insert().
+  template <typename Callback>
+  void forEach(Callback&& callback) const {
+    for (auto& entry : entries)
+      callback(entry->name, entry->logger);
+  }
+
+ private:
+  struct Entry {
+    const std::string name;
+    const LoggerPtr   logger;
+    const std::size_t hash;
+  };
+
+  struct Table {
+    explicit Table(std::size_t capacity);
+
+    void place(const Entry*);
+
+    const std::size_t                            mask;
+    std::size_t                                  size = 0;
+    std::unique_ptr<std::atomic<const Entry*>[]> slots;
+  };
+
+  std::atomic<const Table*>           table;
+  std::vector<std::unique_ptr<Table>> tables;
+  std::vector<std::unique_ptr<Entry>> entries;
+};
+
+}  // namespace cvs::logger
@@ -0,0 +1,48 @@
+#include "namematcher.hpp"
+
+namespace {
+
+// Escaped characters that stay literal, the set of logNameToRegexPattern plus closing brackets.
+constexpr std::string_view escapable = "\\^.[]$()|*+?{}";
+// Characters that make a pattern a regular expression when they are not escaped.
+constexpr std::string_view special = "\\^.[$()|*+?{";
+
+}  // namespace
+
+namespace cvs::logger {
+
+NamePattern::NamePattern(const std::string& pattern)
+    : k(Kind::literal) {
+  for (std::size_t i = 0; i < pattern.size(); ++i) {
+    auto ch = pattern[i];
+    if (ch == '\\' && i + 1 < pattern.size() && escapable.find(pattern[i + 1]) != escapable.npos) {
+      txt.push_back(pattern[++i]);
+      continue;
+    }
+    if (ch == '.' && i + 2 == pattern.size() && pattern[i + 1] == '*') {
+      k = Kind::prefix;
+      break;
+    }
+    if (special.find(ch) != special.npos) {
+      k = Kind::regex;
+      break;
+    }
+    txt.push_back(ch);
+  }
+
+  if (k == Kind::regex) {
+    txt = pattern;
+    re.emplace(pattern);
+  }
+}
+
+bool NamePattern::match(std::string_view name) const {
+  switch (k) {
+    case Kind::literal: return name == txt;
+    case Kind::prefix: return name.substr(0, txt.size()) == txt;
+    case Kind::regex: return std::regex_match(name.begin(), name.end(), *re);
+  }
+  return false;
+}
+
+}  // namespace cvs::logger
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace cvs::logger {
+
+/**
+ * Logger name pattern compiled once. Literal names and `literal.*` prefixes are matched by string
+ * comparison, std::regex is only built for true regular expressions.
+ */
+class NamePattern {
+ public:
+  enum class Kind { literal, prefix, regex };
+
+  explicit NamePattern(const std::string& pattern);
+
+  Kind               kind() const { return k; }
+  const std::string& text() const { return txt; }
+
+  bool match(std::string_view name) const;
+
+ private:
+  Kind                      k;
+  std::string               txt;  // The unescaped name or prefix.
+  std::optional<std::regex> re;
+};
+
+/**
+ * Finds the values whose patterns match a logger name. Literal names are looked up in a hash map,
+ * prefixes in a trie, and only regular expressions are tried one by one.
+ */
+template <typename T>
+class NameIndex {
+ public:
+  void insert(const NamePattern& pattern, T value) {
+    switch (pattern.kind()) {
+      case NamePattern::Kind::literal: literals[pattern.text()].push_back(std::move(value)); break;
+      case NamePattern::Kind::prefix: {
+        auto node = &prefixes;
+        for (auto ch : pattern.text()) {
+          auto& next = node->children[ch];
+          if (!next)
+            next = std::make_unique<Node>();
+          node = next.get();
+        }
+        node->values.push_back(std::move(value));
+      } break;
+      case NamePattern::Kind::regex: regexes.emplace_back(&pattern, std::move(value)); break;
+    }
+  }
+
+  template <typename Callback>
+  void find(std::string_view name, Callback&& callback) const {
+    if (auto iter = literals.find(std::string(name)); iter != literals.end())
+      std::for_each(iter->second.begin(), iter->second.end(), callback);
+
+    auto node = &prefixes;
+    std::for_each(node->values.begin(), node->values.end(), callback);
+    for (auto ch : name) {
+      auto next = node->children.find(ch);
+      if (next == node->children.end())
+        break;
+      node = next->second.get();
+      std::for_each(node->values.begin(), node->values.end(), callback);
+    }
+
+    for (auto& [pattern, value] : regexes) {
+      if (pattern->match(name))
+        callback(value);
+    }
+  }
+
+ private:
+  struct Node {
+    std::unordered_map<char, std::unique_ptr<Node>> children;
+    std::vector<T>                                  values;
+  };
+
+  std::unordered_map<std::string, std::vector<T>>   literals;
+  Node                                              prefixes;
+  std::vector<std::pair<const NamePattern*, T>>     regexes;
+};
+
+}  // namespace cvs::logger
@@ -0,0 +1,200 @@
+#include "segmentcompressor.hpp"
+
+#ifdef CVSLOGGER_ZLIB_ENABLED
+#include <zlib.h>
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t      chunk_size = std::size_t(256) << 10;
+constexpr std::string_view gz_suffix  = ".gz";
+
+bool isDigits(std::string_view str) {
+  return std::all_of(str.begin(), str.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+void lowerPriority() {
+  sched_param param{};
+  if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+    setpriority(PRIO_PROCESS, 0, 19);
+}
+
+#ifdef CVSLOGGER_ZLIB_ENABLED
+bool compressFile(const std::filesystem::path& src) {
+  auto dst = src;
+  dst += gz_suffix;
+  auto tmp = dst;
+  tmp += ".tmp";
+
+  std::ifstream in(src, std::ios::binary);
+  gzFile        out = gzopen(tmp.c_str(), "wb6");
+  if (!in || !out) {
+    if (out)
+      gzclose(out);
+    return false;
+  }
+  gzbuffer(out, chunk_size);
+
+  bool              ok = true;
+  std::vector<char> chunk(chunk_size);
+  while (ok && in) {
+    in.read(chunk.data(), std::streamsize(chunk.size()));
+    if (in.gcount() > 0)
+      ok = gzwrite(out, chunk.data(), unsigned(in.gcount())) == int(in.gcount());
+  }
+  ok = gzclose(out) == Z_OK && ok && !in.bad();
+
+  std::error_code ec;
+  if (!ok) {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  // The segment is replaced only by a complete archive.
+  std::filesystem::rename(tmp, dst, ec);
+  if (!ec)
+    std::filesystem::remove(src, ec);
+  return !ec;
+}
+#endif
+
+}  // namespace
+
+namespace cvs::logger {
+
+SegmentCompressor& SegmentCompressor::instance() {
+  static SegmentCompressor compressor;
+  return compressor;
+}
+
+SegmentCompressor::Segment SegmentCompressor::segmentKind(std::string_view file,
+                                                          std::string_view name) {
+  // <name>.<YYYYmmdd-HHMMSS-mmm>[.<n>].log[.gz]
+  if (file.size() <= name.size() + 1 || file.substr(0, name.size()) != name ||
+      file[name.size()] != '.')
+    return Segment::none;
+  auto rest = file.substr(name.size() + 1);
+  if (rest.size() < 19 || !isDigits(rest.substr(0, 8)) || rest[8] != '-' ||
+      !isDigits(rest.substr(9, 6)) || rest[15] != '-' || !isDigits(rest.substr(16, 3)))
+    return Segment::none;
+  rest.remove_prefix(19);
+
+  auto kind = Segment::plain;
+  if (rest.ends_with(gz_suffix)) {
+    kind = Segment::compressed;
+    rest.remove_suffix(gz_suffix.size());
+  }
+  if (!rest.ends_with(".log"))
+    return Segment::none;
+  rest.remove_suffix(4);
+  if (!rest.empty() && (rest[0] != '.' || rest.size() == 1 || !isDigits(rest.substr(1))))
+    return Segment::none;
+  return kind;
+}
+
+SegmentCompressor::SegmentCompressor()
+    : thread([this] { run(); }) {}
+
+SegmentCompressor::~SegmentCompressor() {
+  {
+    std::lock_guard lock(mutex);
+    stop = true;
+  }
+  cv.notify_one();
+  thread.join();
+}
+
+void SegmentCompressor::schedule(std::filesystem::path dir,
+                                 std::string           name,
+                                 bool                  compress,
+                                 std::size_t           retention) {
+  {
+    std::lock_guard lock(mutex);
+    // A queued job of the logger will see the new segment too.
+    auto it = std::find_if(queue.begin(), queue.end(), [&](const Job& job) {
+      return job.dir == dir && job.name == name;
+    });
+    if (it != queue.end()) {
+      it->compress  = compress;
+      it->retention = retention;
+      return;
+    }
+    queue.push_back({std::move(dir), std::move(name), compress, retention});
+  }
+  cv.notify_one();
+}
+
+void SegmentCompressor::run() {
+  lowerPriority();
+
+  std::unique_lock lock(mutex);
+  while (true) {
+    // Pending jobs are abandoned on exit, the next rotation of the logger handles its segments.
+    cv.wait(lock, [this] { return stop || !queue.empty(); });
+    if (stop)
+      break;
+
+    auto job = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+    try {
+      process(job);
+    }
+    catch (const std::exception&) {
+      // The directory may be gone, the segments are retried on the next rotation.
+    }
+    lock.lock();
+  }
+}
+
+void SegmentCompressor::process(const Job& job) {
+  struct Entry {
+    std::filesystem::path path;
+    Segment               kind;
+  };
+
+  std::vector<Entry> segments;
+  for (auto& entry : std::filesystem::directory_iterator(job.dir)) {
+    auto kind = segmentKind(entry.path().filename().native(), job.name);
+    if (kind != Segment::none && entry.is_regular_file())
+      segments.push_back({entry.path(), kind});
+  }
+  // Start times in the names order the segments chronologically.
+  std::sort(segments.begin(), segments.end(),
+            [](const Entry& e0, const Entry& e1) { return e0.path < e1.path; });
+
+#ifdef CVSLOGGER_ZLIB_ENABLED
+  if (job.compress) {
+    for (auto& segment : segments) {
+      if (segment.kind == Segment::plain && compressFile(segment.path)) {
+        segment.path += gz_suffix;
+        segment.kind = Segment::compressed;
+      }
+    }
+  }
+#endif
+
+  if (job.retention == 0)
+    return;
+
+  std::size_t total = 0;
+  for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+    std::error_code ec;
+    auto            size = std::filesystem::file_size(it->path, ec);
+    if (ec)
+      continue;
+    total += size;
+    if (total > job.retention)
+      std::filesystem::remove(it->path, ec);
+  }
+}
+
+}  // namespace cvs::logger
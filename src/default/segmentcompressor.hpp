@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace cvs::logger {
+
+/**
+ * Background thread with the idle scheduling priority that compresses the rotated segments of
+ * FileSink and removes the oldest of them over the retention budget. A job handles all rotated
+ * segments of a logger, so segments left uncompressed by a previous run are picked up as well.
+ */
+class SegmentCompressor {
+ public:
+  enum class Segment { none, plain, compressed };
+
+  static SegmentCompressor& instance();
+
+  // Kind of `file` if it is a rotated segment of the logger `name`.
+  static Segment segmentKind(std::string_view file, std::string_view name);
+
+  ~SegmentCompressor();
+
+  void schedule(std::filesystem::path dir, std::string name, bool compress, std::size_t retention);
+
+ private:
+  struct Job {
+    std::filesystem::path dir;
+    std::string           name;
+    bool                  compress;
+    std::size_t           retention;
+  };
+
+  SegmentCompressor();
+
+  void run();
+  void process(const Job&);
+
+  std::mutex              mutex;
+  std::condition_variable cv;
+  std::deque<Job>         queue;
+  bool                    stop = false;
+
+  std::thread thread;
+};
+
+}  // namespace cvs::logger
@@ -0,0 +1,318 @@
+#include "deferredbackend.hpp"
+
+#include <cvs/logger/ilogger.hpp>
+
+#include <fmt/args.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace cvs::logger;
+
+namespace {
+
+// Polling interval of the backend thread when the rings are empty.
+constexpr auto poll_interval = std::chrono::milliseconds(1);
+
+template <typename T>
+void put(std::ofstream& file, const T& value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put(std::ofstream& file, std::string_view str) {
+  put(file, std::uint32_t(str.size()));
+  file.write(str.data(), str.size());
+}
+
+class Reader {
+ public:
+  explicit Reader(std::string_view data)
+      : data(data) {}
+
+  bool atEnd() const { return pos >= data.size(); }
+
+  template <typename T>
+  T get() {
+    T value{};
+    std::memcpy(&value, bytes(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  std::string_view bytes(std::size_t size) {
+    if (size > data.size() - pos)
+      throw std::runtime_error("Truncated log");
+    auto view = data.substr(pos, size);
+    pos += size;
+    return view;
+  }
+
+  std::string_view string() { return bytes(get<std::uint32_t>()); }
+
+ private:
+  std::string_view data;
+  std::size_t      pos = 0;
+};
+
+struct Format {
+  std::vector<deferred::Tag> tags;
+  std::string_view           format;
+};
+
+std::string formatMessage(const Format& format, std::string_view args) {
+  using deferred::Tag;
+  fmt::dynamic_format_arg_store<fmt::format_context> store;
+
+  Reader in{args};
+  for (auto tag : format.tags) {
+    switch (tag) {
+      case Tag::boolean: store.push_back(in.get<bool>()); break;
+      case Tag::character: store.push_back(in.get<char>()); break;
+      case Tag::i8: store.push_back(in.get<std::int8_t>()); break;
+      case Tag::u8: store.push_back(in.get<std::uint8_t>()); break;
+      case Tag::i16: store.push_back(in.get<std::int16_t>()); break;
+      case Tag::u16: store.push_back(in.get<std::uint16_t>()); break;
+      case Tag::i32: store.push_back(in.get<std::int32_t>()); break;
+      case Tag::u32: store.push_back(in.get<std::uint32_t>()); break;
+      case Tag::i64: store.push_back(in.get<std::int64_t>()); break;
+      case Tag::u64: store.push_back(in.get<std::uint64_t>()); break;
+      case Tag::f32: store.push_back(in.get<float>()); break;
+      case Tag::f64: store.push_back(in.get<double>()); break;
+      case Tag::string: store.push_back(std::string(in.string())); break;
+    }
+  }
+  return fmt::vformat(format.format, store);
+}
+
+}  // namespace
+
+namespace cvs::logger::deferred {
+
+ThreadRing::ThreadRing()
+    : buffer(new char[capacity]) {}
+
+ThreadRing& threadRing() {
+  thread_local auto ring = DeferredBackend::instance().registerRing();
+  return *ring;
+}
+
+void flush() { DeferredBackend::instance().flush(); }
+
+std::size_t dropped() { return DeferredBackend::instance().dropped(); }
+
+}  // namespace cvs::logger::deferred
+
+namespace cvs::logger {
+
+DeferredBackend& DeferredBackend::instance() {
+  static DeferredBackend backend;
+  return backend;
+}
+
+DeferredBackend::DeferredBackend()
+    : thread([this] { run(); }) {}
+
+std::filesystem::path DeferredBackend::logFile(const std::filesystem::path& dir) {
+  return dir / ("cvslogger-" + std::to_string(getpid()) + ".clog");
+}
+
+void DeferredBackend::decode(std::string_view log, const std::function<void(const Message&)>& fn) {
+  Reader in{log};
+  if (in.bytes(sizeof(file_magic)) != std::string_view(file_magic, sizeof(file_magic)))
+    throw std::runtime_error("Not a binary log");
+
+  std::unordered_map<std::uint32_t, Format>           formats;
+  std::unordered_map<std::uint32_t, std::string_view> loggers;
+  while (!in.atEnd()) {
+    switch (in.get<std::uint8_t>()) {
+      case format_entry: {
+        auto& format = formats[in.get<std::uint32_t>()];
+        auto  tags   = in.bytes(in.get<std::uint32_t>());
+        format.tags.assign(reinterpret_cast<const deferred::Tag*>(tags.data()),
+                           reinterpret_cast<const deferred::Tag*>(tags.data() + tags.size()));
+        format.format = in.string();
+        break;
+      }
+      case logger_entry: {
+        auto id     = in.get<std::uint32_t>();
+        loggers[id] = in.string();
+        break;
+      }
+      case message_entry: {
+        auto    format = in.get<std::uint32_t>();
+        Message message;
+        message.logger    = loggers[in.get<std::uint32_t>()];
+        message.level     = Level(in.get<std::uint8_t>());
+        message.timestamp = in.get<std::int64_t>();
+        auto args         = in.string();
+        try {
+          message.text = formatMessage(formats.at(format), args);
+        }
+        catch (const std::exception& e) {
+          message.text = fmt::format("<{}>", e.what());
+        }
+        fn(message);
+        break;
+      }
+      default: throw std::runtime_error("Unknown entry");
+    }
+  }
+}
+
+DeferredBackend::~DeferredBackend() {
+  {
+    std::lock_guard lock(mutex);
+    stop = true;
+  }
+  wake.notify_one();
+  thread.join();
+}
+
+std::shared_ptr<deferred::ThreadRing> DeferredBackend::registerRing() {
+  auto            ring = std::make_shared<deferred::ThreadRing>();
+  std::lock_guard lock(mutex);
+  rings.push_back(ring);
+  return ring;
+}
+
+void DeferredBackend::flush() {
+  std::unique_lock lock(mutex);
+  // The pass in progress may have missed the latest records, the next one will see them.
+  auto target = passes + 2;
+  wake.notify_one();
+  done.wait(lock, [&] { return passes >= target; });
+}
+
+std::size_t DeferredBackend::dropped() {
+  std::lock_guard lock(mutex);
+  auto            count = retired_dropped;
+  for (auto& r : rings)
+    count += r->dropped.load(std::memory_order_relaxed);
+  return count;
+}
+
+void DeferredBackend::run() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    lock.unlock();
+    bool active = poll();
+    lock.lock();
+
+    ++passes;
+    done.notify_all();
+
+    // Rings of finished threads are removed once they are drained.
+    std::erase_if(rings, [this](const auto& r) {
+      if (r.use_count() > 1 || r->readPos() != r->writePos())
+        return false;
+      retired_dropped += r->dropped.load(std::memory_order_relaxed);
+      return true;
+    });
+
+    if (stop && !active)
+      break;
+    if (!active)
+      wake.wait_for(lock, poll_interval);
+  }
+}
+
+bool DeferredBackend::poll() {
+  std::vector<std::shared_ptr<deferred::ThreadRing>> snapshot;
+  {
+    std::lock_guard lock(mutex);
+    snapshot = rings;
+  }
+
+  std::vector<const deferred::RecordHeader*> records;
+  std::vector<std::size_t>                   ends(snapshot.size());
+  for (std::size_t i = 0; i < snapshot.size(); ++i) {
+    auto& ring = *snapshot[i];
+    auto  pos  = ring.readPos();
+    auto  end  = ring.writePos();
+    while (pos < end) {
+      auto record = reinterpret_cast<const deferred::RecordHeader*>(ring.at(pos));
+      if (record->size == 0) {
+        pos += deferred::ThreadRing::capacity - (pos & (deferred::ThreadRing::capacity - 1));
+        continue;
+      }
+      records.push_back(record);
+      pos += record->size;
+    }
+    ends[i] = end;
+  }
+
+  // Records of one thread are already ordered, the stable sort keeps them so.
+  std::stable_sort(records.begin(), records.end(), [](auto r0, auto r1) {
+    return r0->timestamp < r1->timestamp;
+  });
+  for (auto record : records)
+    write(*record);
+  for (auto& log : binary_logs)
+    log.second.file.flush();
+
+  for (std::size_t i = 0; i < snapshot.size(); ++i)
+    snapshot[i]->release(ends[i]);
+
+  return !records.empty();
+}
+
+void DeferredBackend::write(const deferred::RecordHeader& record) {
+  auto logger = record.logger;
+  if (logger->backend.load(std::memory_order_relaxed) == Backend::binary) {
+    writeBinary(record);
+    return;
+  }
+
+  auto args = reinterpret_cast<const char*>(&record + 1);
+  auto time = spdlog::log_clock::time_point(std::chrono::duration_cast<spdlog::log_clock::duration>(
+      std::chrono::nanoseconds(record.timestamp)));
+  try {
+    auto msg = record.args->format(std::string_view(record.format, record.format_size), args);
+    logger->logger->log(time, spdlog::source_loc{}, ILogger::convertLogLevel(record.level), msg);
+  }
+  catch (const std::exception& e) {
+    logger->logger->log(time, spdlog::source_loc{}, spdlog::level::err, e.what());
+  }
+}
+
+void DeferredBackend::writeBinary(const deferred::RecordHeader& record) {
+  // Published before the backend of the logger was set, see ILogger::setBackend.
+  auto  target = record.logger->binary_target.load(std::memory_order_acquire);
+  auto& log    = binary_logs[target->file];
+  if (!log.file.is_open()) {
+    std::error_code ec;
+    std::filesystem::create_directories(target->file.parent_path(), ec);
+    log.file.open(target->file, std::ios::binary | std::ios::trunc);
+    log.file.write(file_magic, sizeof(file_magic));
+  }
+
+  BinaryLog::FormatKey key(record.format, record.args);
+  auto [format, format_added] = log.formats.try_emplace(key, std::uint32_t(log.formats.size()));
+  if (format_added) {
+    put(log.file, format_entry);
+    put(log.file, format->second);
+    put(log.file, std::uint32_t(record.args->count));
+    log.file.write(reinterpret_cast<const char*>(record.args->tags), record.args->count);
+    put(log.file, std::string_view(record.format, record.format_size));
+  }
+
+  auto [logger, logger_added] =
+      log.loggers.try_emplace(record.logger, std::uint32_t(log.loggers.size()));
+  if (logger_added) {
+    put(log.file, logger_entry);
+    put(log.file, logger->second);
+    put(log.file, std::string_view(target->name));
+  }
+
+  put(log.file, message_entry);
+  put(log.file, format->second);
+  put(log.file, logger->second);
+  put(log.file, std::uint8_t(record.level));
+  put(log.file, record.timestamp);
+  put(log.file, std::string_view(reinterpret_cast<const char*>(&record + 1),
+                                 record.size - sizeof(deferred::RecordHeader)));
+}
+
+}  // namespace cvs::logger
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cvs/logger/deferred.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cvs::logger {
+
+/**
+ * Backend thread of Backend::deferred and Backend::binary. Every pass collects the records of all
+ * thread rings, orders them by timestamp and formats them to the sinks of their loggers or appends
+ * them to a binary log.
+ *
+ * A binary log starts with `file_magic`, followed by entries of a one byte kind:
+ *   - `format_entry`: u32 id, u32 count, count tags, u32 size, format string;
+ *   - `logger_entry`: u32 id, u32 size, logger name;
+ *   - `message_entry`: u32 format id, u32 logger id, u8 level, i64 timestamp ns, u32 size, packed
+ *     arguments.
+ * Formats and loggers are described once per file before the first message that refers to them.
+ */
+class DeferredBackend {
+ public:
+  static constexpr char file_magic[8] = {'C', 'V', 'S', 'C', 'L', 'O', 'G', '1'};
+
+  static constexpr std::uint8_t format_entry  = 1;
+  static constexpr std::uint8_t logger_entry  = 2;
+  static constexpr std::uint8_t message_entry = 3;
+
+  // Message read back from a binary log.
+  struct Message {
+    std::string_view logger;
+    Level            level;
+    std::int64_t     timestamp;  // Nanoseconds since the epoch.
+    std::string      text;
+  };
+
+  static DeferredBackend& instance();
+
+  // The binary log of this process in `dir`.
+  static std::filesystem::path logFile(const std::filesystem::path& dir);
+
+  /**
+   * Passes the messages of a binary log to `fn` in order. A message whose arguments don't match its
+   * format gets the error as its text. Throws std::runtime_error if `log` is not a binary log or is
+   * truncated.
+   */
+  static void decode(std::string_view log, const std::function<void(const Message&)>& fn);
+
+  ~DeferredBackend();
+
+  std::shared_ptr<deferred::ThreadRing> registerRing();
+
+  void        flush();
+  std::size_t dropped();
+
+ private:
+  struct BinaryLog {
+    using FormatKey = std::pair<const char*, const deferred::ArgsInfo*>;
+
+    std::ofstream                                     file;
+    std::map<FormatKey, std::uint32_t>                formats;
+    std::unordered_map<const ILogger*, std::uint32_t> loggers;
+  };
+
+  DeferredBackend();
+
+  void run();
+  bool poll();
+  void write(const deferred::RecordHeader& record);
+  void writeBinary(const deferred::RecordHeader& record);
+
+  std::mutex                                         mutex;
+  std::condition_variable                            wake;
+  std::condition_variable                            done;
+  std::vector<std::shared_ptr<deferred::ThreadRing>> rings;
+  std::size_t                                        passes          = 0;
+  std::size_t                                        retired_dropped = 0;
+  bool                                               stop            = false;
+
+  // Used by the backend thread only.
+  std::map<std::filesystem::path, BinaryLog> binary_logs;
+
+  std::thread thread;
+};
+
+}  // namespace cvs::logger
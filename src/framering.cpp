@@ -0,0 +1,156 @@
+#include "framering.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+
+namespace {
+
+constexpr std::size_t alignUp(std::size_t size, std::size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+namespace cvs::logger {
+
+FrameRing::FrameRing(std::filesystem::path file, std::size_t capacity)
+    : file_path(std::move(file))
+    , cap(ringCapacity(capacity)) {
+  std::filesystem::create_directories(file_path.parent_path());
+
+  const auto file_size = data_offset + cap;
+
+  struct stat st {};
+  bool        reuse = ::stat(file_path.c_str(), &st) == 0 && std::size_t(st.st_size) == file_size;
+  // A ring with another geometry is replaced by a new file, so mappings of the old one stay valid.
+  if (!reuse)
+    std::filesystem::remove(file_path);
+
+  fd = ::open(file_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0)
+    throw std::system_error(errno, std::generic_category(), "Can't open " + file_path.string());
+
+  if (!reuse && ::ftruncate(fd, off_t(file_size)) != 0) {
+    ::close(fd);
+    throw std::system_error(errno, std::generic_category(), "Can't resize " + file_path.string());
+  }
+  // Allocate the blocks up front so writes never hit a full disk or a sparse-file fault.
+  if (auto error = ::posix_fallocate(fd, 0, off_t(file_size)); error != 0) {
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "Can't allocate " + file_path.string());
+  }
+
+  void* addr = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    ::close(fd);
+    throw std::system_error(errno, std::generic_category(), "Can't map " + file_path.string());
+  }
+
+  base   = static_cast<unsigned char*>(addr);
+  header = reinterpret_cast<FileHeader*>(base);
+  // An existing ring with the same geometry is continued, so frames of a previous run survive.
+  if (!reuse || header->magic != file_magic || header->capacity != cap ||
+      header->write_pos > cap) {
+    header->capacity  = cap;
+    header->write_pos = 0;
+    header->next_seq  = 0;
+    header->magic     = file_magic;
+  }
+}
+
+FrameRing::~FrameRing() {
+  ::munmap(base, data_offset + cap);
+  ::close(fd);
+}
+
+const std::filesystem::path& FrameRing::path() const { return file_path; }
+
+std::size_t FrameRing::capacity() const { return cap; }
+
+FrameRing::Reservation FrameRing::reserve(std::size_t size) {
+  size = alignUp(size, alignment);
+  if (size > cap)
+    return {};
+
+  std::lock_guard lock(mutex);
+
+  auto pos  = header->write_pos;
+  auto wrap = pos + size > cap;
+  auto skip = wrap ? cap - pos : 0;
+  // The bytes of a record are reused once the ring advanced by `cap` past its start.
+  if (!writing.empty() && reserved + skip + size > writing.front() + cap)
+    return {};
+
+  if (wrap) {
+    if (skip >= sizeof(FrameRecord)) {
+      auto marker   = reinterpret_cast<FrameRecord*>(base + data_offset + pos);
+      marker->size  = skip;
+      marker->magic = skip_magic;
+    }
+    pos = 0;
+  }
+
+  Reservation reservation{reinterpret_cast<FrameRecord*>(base + data_offset + pos),
+                          reserved + skip};
+  reserved += skip + size;
+  header->write_pos = pos + size;
+  writing.push_back(reservation.start);
+
+  auto record = reservation.record;
+  std::atomic_ref<std::uint32_t>(record->magic).store(0, std::memory_order_relaxed);
+  record->seq  = header->next_seq++;
+  record->size = size;
+  return reservation;
+}
+
+void FrameRing::commit(const Reservation& reservation) {
+  // The magic marks the record as complete for readers of the file.
+  std::atomic_ref<std::uint32_t>(reservation.record->magic)
+      .store(record_magic, std::memory_order_release);
+
+  std::lock_guard lock(mutex);
+  writing.erase(std::find(writing.begin(), writing.end(), reservation.start));
+}
+
+std::int64_t FrameRing::write(int                  level,
+                              int                  rows,
+                              int                  cols,
+                              int                  type,
+                              std::size_t          row_bytes,
+                              const unsigned char* data,
+                              std::size_t          step) {
+  auto reservation = reserve(sizeof(FrameRecord) + row_bytes * std::size_t(rows));
+  auto record      = reservation.record;
+  if (!record)
+    return -1;
+
+  record->level     = std::uint32_t(level);
+  record->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+  record->rows     = rows;
+  record->cols     = cols;
+  record->type     = type;
+  record->reserved = 0;
+  record->step     = row_bytes;
+
+  auto dst = reinterpret_cast<unsigned char*>(record + 1);
+  if (step == row_bytes)
+    std::memcpy(dst, data, row_bytes * std::size_t(rows));
+  else {
+    for (int r = 0; r < rows; ++r)
+      std::memcpy(dst + r * row_bytes, data + r * step, row_bytes);
+  }
+
+  commit(reservation);
+  return reinterpret_cast<unsigned char*>(record) - base;
+}
+
+}  // namespace cvs::logger
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace cvs::logger {
+
+/**
+ * Preallocated memory-mapped ring file of raw frames used by LogImage::raw. The file starts with
+ * a FileHeader page followed by the data area. Every record is a FrameRecord and the packed pixel
+ * rows, aligned to `alignment` bytes. Records that do not fit before the end of the data area
+ * restart at its beginning and overwrite the oldest frames. A frame that would overwrite a record
+ * still being written is dropped instead, so a complete record never holds torn pixels.
+ */
+class FrameRing {
+ public:
+  static constexpr std::uint64_t file_magic   = 0x31474e4952535643;  // "CVSRING1"
+  static constexpr std::uint32_t record_magic = 0x46535643;          // "CVSF"
+  static constexpr std::uint32_t skip_magic   = 0x50535643;          // "CVSP"
+  static constexpr std::size_t   alignment    = 64;
+  static constexpr std::size_t   data_offset  = 4096;
+
+  struct FileHeader {
+    std::uint64_t magic;
+    std::uint64_t capacity;
+    std::uint64_t write_pos;
+    std::uint64_t next_seq;
+  };
+
+  struct FrameRecord {
+    std::uint32_t magic;
+    std::uint32_t level;
+    std::uint64_t seq;
+    std::int64_t  timestamp;  // Nanoseconds since the epoch.
+    std::int32_t  rows;
+    std::int32_t  cols;
+    std::int32_t  type;  // OpenCV type of the frame.
+    std::uint32_t reserved;
+    std::uint64_t step;  // Bytes per stored row.
+    std::uint64_t size;  // Record size including this header and the alignment padding.
+  };
+
+  // Size of the data area for a requested ring size.
+  static constexpr std::size_t ringCapacity(std::size_t bytes) {
+    return (bytes + alignment - 1) / alignment * alignment;
+  }
+
+  FrameRing(std::filesystem::path file, std::size_t capacity);
+  ~FrameRing();
+
+  FrameRing(const FrameRing&) = delete;
+  FrameRing& operator=(const FrameRing&) = delete;
+
+  // Record space taken by reserve() and written by its owner until commit().
+  struct Reservation {
+    FrameRecord*  record = nullptr;
+    std::uint64_t start  = 0;  // Bytes reserved before the record since the ring was opened.
+  };
+
+  const std::filesystem::path& path() const;
+  std::size_t                  capacity() const;
+
+  /**
+   * Takes `size` bytes, aligned up, for a record and sets its `seq` and `size`. The record stays
+   * incomplete until commit(). The record is null if the frame is larger than the ring or would
+   * overwrite a record that is not committed yet.
+   */
+  Reservation reserve(std::size_t size);
+  // Marks the record as complete once its header and pixels are written.
+  void commit(const Reservation& reservation);
+
+  /**
+   * Copies `rows` rows of `row_bytes` bytes, `step` bytes apart, into the ring. Returns the record
+   * offset in the file or -1 if the frame was dropped by reserve().
+   */
+  std::int64_t write(int                  level,
+                     int                  rows,
+                     int                  cols,
+                     int                  type,
+                     std::size_t          row_bytes,
+                     const unsigned char* data,
+                     std::size_t          step);
+
+ private:
+  const std::filesystem::path file_path;
+  const std::size_t           cap;
+
+  int            fd   = -1;
+  unsigned char* base = nullptr;
+  FileHeader*    header = nullptr;
+
+  std::mutex                 mutex;
+  std::uint64_t              reserved = 0;  // Bytes reserved since the ring was opened.
+  std::vector<std::uint64_t> writing;       // Starts of the uncommitted records, oldest first.
+};
+
+}  // namespace cvs::logger
@@ -1,24 +1,126 @@
 #include "../include/cvs/logger/ilogger.hpp"
+#include "deferredbackend.hpp"
+
+#include <spdlog/sinks/sink.h>
+
+#include <bit>
+
+namespace cvs::logger {
+
+std::vector<std::string>& ILogger::messageImages() {
+  thread_local std::vector<std::string> images;
+  return images;
+}
+
+LoggerStats ILogger::stats() const {
+  auto stats    = counters->load();
+  stats.dropped = dropped();
+  return stats;
+}
+
+void ILogger::dumpRecorder() {
+  auto r = recorder.load(std::memory_order_acquire);
+  if (!r)
+    return;
+
+  // The messages are below the logger level, so they bypass its filter.
+  r->dump([this](Level l, std::chrono::nanoseconds time, std::string_view text) {
+    spdlog::details::log_msg msg(
+        spdlog::log_clock::time_point(
+            std::chrono::duration_cast<spdlog::log_clock::duration>(time)),
+        spdlog::source_loc{}, logger->name(), convertLogLevel(l), text);
+    for (auto& sink : logger->sinks()) {
+      if (sink->should_log(msg.level))
+        sink->log(msg);
+    }
+  });
+}
+
+void ILogger::setBackend(Backend b) {
+  // Records of the backend are only pushed once their binary log is published.
+  if (b != Backend::spdlog && !binary_target.load(std::memory_order_relaxed))
+    updateBinaryLog();
+  backend.store(b, std::memory_order_release);
+}
+
+void ILogger::updateBinaryLog() {
+  binary_target.store(std::make_shared<const BinaryTarget>(
+                          BinaryTarget{std::string(name()), DeferredBackend::logFile(path())}),
+                      std::memory_order_release);
+}
+
+void ILogger::setRecorder(const Recorder& config) {
+  recorder_level.store(config.level, std::memory_order_relaxed);
+  if (config.level == Level::off)
+    recorder.store(nullptr, std::memory_order_release);
+  else {
+    auto r = recorder.load(std::memory_order_relaxed);
+    if (!r && !recorders.empty())
+      r = recorders.back().get();
+    if (!r || r->capacity() != std::bit_ceil(std::max<std::size_t>(config.slots, 1))) {
+      if (r)
+        r->retire();
+      recorders.push_back(std::make_unique<FlightRecorder>(name(), config));
+      r = recorders.back().get();
+    }
+    r->setLevels(config.level, config.dump_level);
+    recorder.store(r, std::memory_order_release);
+
+    if (config.crash_dump)
+      installCrashHandler();
+  }
+}
+
+}  // namespace cvs::logger
 
 #ifdef CVS_LOGGER_OPENCV_ENABLED
 
+#include "framering.hpp"
+#include "imagewriter.hpp"
+
 namespace cvs::logger {
 
 template <>
 ILogger::Strategy<cv::Mat>::Type ILogger::processArg<cv::Mat>(Level l, const cv::Mat& arg) {
   static std::atomic_size_t id{0};
-  if (logImage() == LogImage::enable) {
-    auto save_path = path() / "images" / name() / std::to_string(int(l));
-    std::filesystem::create_directories(save_path);
-    save_path /= std::to_string(id++) + ".png";
-    cv::imwrite(save_path.string(), arg);
+  auto                      mode = logImage();
+  if (mode == LogImage::enable) {
+    auto save_dir  = path() / "images" / name() / std::to_string(int(l));
+    auto save_path = (save_dir / (std::to_string(id++) + ".png")).string();
+    if (!ImageWriter::instance().push(std::move(save_dir), save_path, arg))
+      return std::string("Img(dropped)");
+    counters->image(arg.total() * arg.elemSize());
 
-    return "Img(" + save_path.string() + ")";
+    messageImages().push_back(save_path);
+    return "Img(" + save_path + ")";
+  }
+
+  if (mode == LogImage::raw) {
+    if (arg.dims != 2)
+      return std::string("Img(not saved)");
+    // The ring file could not be created.
+    auto ring = frameRing();
+    if (!ring)
+      return std::string("Img(dropped)");
+
+    auto offset = ring->write(int(l), arg.rows, arg.cols, arg.type(), arg.cols * arg.elemSize(),
+                              arg.data, arg.step[0]);
+    if (offset < 0)
+      return std::string("Img(dropped)");
+    counters->image(arg.total() * arg.elemSize());
+
+    auto image = ring->path().string() + "@" + std::to_string(offset);
+    messageImages().push_back(image);
+    return "Img(" + image + ")";
   }
 
   return std::string("Img(not saved)");
 }
 
+void flushImages() { ImageWriter::instance().flush(); }
+
+std::size_t droppedImages() { return ImageWriter::instance().dropped(); }
+
 }  // namespace cvs::logger
 
 #endif
@@ -0,0 +1,97 @@
+#include "imagewriter.hpp"
+
+#ifdef CVS_LOGGER_OPENCV_ENABLED
+
+#include <opencv2/imgcodecs.hpp>
+
+namespace {
+
+constexpr std::size_t queue_capacity = 64;
+constexpr std::size_t writer_threads = 2;
+
+}  // namespace
+
+namespace cvs::logger {
+
+ImageWriter& ImageWriter::instance() {
+  static ImageWriter writer(queue_capacity, writer_threads);
+  return writer;
+}
+
+ImageWriter::ImageWriter(std::size_t cap, std::size_t thread_count)
+    : capacity(cap) {
+  for (std::size_t i = 0; i < thread_count; ++i)
+    threads.emplace_back([this]() { run(); });
+}
+
+ImageWriter::~ImageWriter() {
+  {
+    std::lock_guard lock(mutex);
+    stop = true;
+  }
+  not_empty.notify_all();
+  for (auto& t : threads)
+    t.join();
+}
+
+bool ImageWriter::push(std::filesystem::path dir, std::string file, cv::Mat image) {
+  {
+    std::lock_guard lock(mutex);
+    if (stop || queue.size() >= capacity) {
+      ++dropped_cnt;
+      return false;
+    }
+    queue.push_back({std::move(dir), std::move(file), std::move(image)});
+  }
+  not_empty.notify_one();
+  return true;
+}
+
+void ImageWriter::flush() {
+  std::unique_lock lock(mutex);
+  idle.wait(lock, [this]() { return queue.empty() && busy == 0; });
+}
+
+std::size_t ImageWriter::dropped() const { return dropped_cnt.load(std::memory_order_relaxed); }
+
+void ImageWriter::run() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    not_empty.wait(lock, [this]() { return stop || !queue.empty(); });
+    // Queued images are written before the pool stops.
+    if (queue.empty())
+      return;
+
+    auto job = std::move(queue.front());
+    queue.pop_front();
+    ++busy;
+    lock.unlock();
+
+    write(job);
+
+    lock.lock();
+    --busy;
+    if (queue.empty() && busy == 0)
+      idle.notify_all();
+  }
+}
+
+void ImageWriter::write(const Job& job) {
+  try {
+    {
+      std::lock_guard lock(dirs_mutex);
+      if (auto dir = job.dir.string(); !created_dirs.count(dir)) {
+        std::filesystem::create_directories(job.dir);
+        created_dirs.insert(std::move(dir));
+      }
+    }
+    cv::imwrite(job.file, job.image);
+  }
+  catch (...) {
+    // The image is lost, but the writer keeps serving the queue.
+  }
+}
+
+}  // namespace cvs::logger
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#ifdef CVS_LOGGER_OPENCV_ENABLED
+
+#include <opencv2/core/mat.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace cvs::logger {
+
+/**
+ * Bounded pool that encodes and writes logged images in the background. The queue keeps a
+ * refcounted cv::Mat header, so pixels changed by the caller after logging end up in the file.
+ */
+class ImageWriter {
+ public:
+  static ImageWriter& instance();
+
+  ~ImageWriter();
+
+  // Returns false if the queue is full and the image is dropped.
+  bool        push(std::filesystem::path dir, std::string file, cv::Mat image);
+  void        flush();
+  std::size_t dropped() const;
+
+ private:
+  struct Job {
+    std::filesystem::path dir;
+    std::string           file;
+    cv::Mat               image;
+  };
+
+  ImageWriter(std::size_t capacity, std::size_t threads);
+
+  void run();
+  void write(const Job&);
+
+  const std::size_t capacity;
+
+  std::deque<Job> queue;
+  std::size_t     busy = 0;
+  bool            stop = false;
+
+  std::mutex              mutex;
+  std::condition_variable not_empty, idle;
+
+  std::mutex                      dirs_mutex;
+  std::unordered_set<std::string> created_dirs;
+
+  std::atomic_size_t       dropped_cnt{0};
+  std::vector<std::thread> threads;
+};
+
+}  // namespace cvs::logger
+
+#endif
@@ -6,6 +6,8 @@
 #include <spdlog/spdlog.h>
 
 #include <functional>
+#include <type_traits>
+#include <variant>
 
 using namespace cvs::logger;
 
@@ -13,6 +15,8 @@ namespace cvs::logger {
 
 const std::string_view LoggerFactory::default_logger_name;
 
+std::atomic_uint64_t LoggerFactory::cache_generation{1};
+
 std::function<LoggerFactorPtr()> LoggerFactory::creator = []() {
   static auto factory = std::make_shared<DefaultLoggerFactory>();
   return factory;
@@ -22,10 +26,53 @@ LoggerFactorPtr LoggerFactory::instance() { return creator(); }
 
 void LoggerFactory::registerCreator(std::function<LoggerFactorPtr()> new_creator) {
   creator = std::move(new_creator);
+  invalidateCache();
 }
 
+Stats LoggerFactory::statsImpl() { return {}; }
+
+void LoggerFactory::invalidateCache() { cache_generation.fetch_add(1, std::memory_order_acq_rel); }
+
 void LoggerFactory::configureImpl(std::string_view name, std::any val) {
   configureImpl(Regex(logNameToRegexPattern(name)), std::move(val));
 }
 
+void LoggerFactory::configureImpl(const Config& config) {
+  for (auto& rule : config.rules()) {
+    auto pattern = rule.regex ? rule.name : logNameToRegexPattern(rule.name);
+    for (auto& option : rule.options)
+      std::visit(
+          [&](const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, Config::PatternOption>)
+              configureImpl(Regex(pattern), std::make_any<Pattern>(value.text, value.time_type));
+            else
+              configureImpl(Regex(pattern), std::make_any<T>(value));
+          },
+          option);
+  }
+  configureImpl();
+}
+
+CachedLogger::CachedLogger(std::string_view n)
+    : name(n) {}
+
+ILogger* CachedLogger::refresh() {
+  std::lock_guard lock(mutex);
+
+  auto gen = LoggerFactory::cacheGeneration();
+  if (generation.load(std::memory_order_relaxed) != gen) {
+    auto fresh = LoggerFactory::getLogger(name);
+    if (fresh != holder) {
+      if (holder)
+        retired.push_back(std::move(holder));
+      holder = std::move(fresh);
+      logger.store(holder.get(), std::memory_order_relaxed);
+    }
+    generation.store(gen, std::memory_order_release);
+  }
+
+  return logger.load(std::memory_order_relaxed);
+}
+
 }  // namespace cvs::logger
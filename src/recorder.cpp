@@ -0,0 +1,286 @@
+#include "../include/cvs/logger/recorder.hpp"
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+using namespace cvs::logger;
+
+namespace {
+
+// Recorders dumped on fatal signals. The signal handler can't lock, so the slots are atomic.
+std::array<std::atomic<FlightRecorder*>, 64> registry{};
+std::atomic_size_t                           unregistered_cnt{0};
+
+constexpr std::string_view level_names[] = {"trace", "debug",    "info", "warning",
+                                            "error", "critical", "off"};
+
+constexpr int crash_signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+struct sigaction previous_actions[std::size(crash_signals)];
+std::atomic_bool crashed{false};
+
+void onCrash(int signal) {
+  if (!crashed.exchange(true))
+    FlightRecorder::dumpAll(STDERR_FILENO);
+
+  // The signal is delivered again to the previous handler once this one returns.
+  for (std::size_t i = 0; i < std::size(crash_signals); ++i) {
+    if (crash_signals[i] == signal)
+      sigaction(signal, &previous_actions[i], nullptr);
+  }
+  raise(signal);
+}
+
+// Copy of a complete slot.
+struct Message {
+  std::int64_t              timestamp;
+  const char*               format;
+  const deferred::ArgsInfo* args;
+  std::uint32_t             format_size;
+  Level                     level;
+  std::uint16_t             size;
+  char                      data[sizeof(FlightRecorder::Slot::data)];
+
+  std::string_view formatString() const { return {format, format_size}; }
+  std::string_view text() const { return {data, size}; }
+};
+
+/**
+ * Line of the crash dump in a fixed buffer, the text that doesn't fit is dropped. The signal
+ * handler uses it, so it neither allocates nor throws.
+ */
+class Line {
+ public:
+  void text(std::string_view s) {
+    auto n = std::min(s.size(), sizeof(buffer) - size);
+    std::memcpy(buffer + size, s.data(), n);
+    size += n;
+  }
+
+  template <typename T>
+  void number(T value) {
+    char digits[64];
+    auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+    text({digits, std::size_t(result.ptr - digits)});
+  }
+
+  // Unsigned `value` padded with zeros to `width` digits.
+  void padded(std::uint64_t value, std::size_t width) {
+    char digits[20];
+    auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+    for (auto n = std::size_t(result.ptr - digits); n < width; ++n)
+      text("0");
+    text({digits, std::size_t(result.ptr - digits)});
+  }
+
+  // Writes the line and a newline to `fd`.
+  void write(int fd) {
+    size = std::min(size, sizeof(buffer) - 1);
+    buffer[size++] = '\n';
+    [[maybe_unused]] auto written = ::write(fd, buffer, size);
+    size                          = 0;
+  }
+
+ private:
+  char        buffer[1024];
+  std::size_t size = 0;
+};
+
+template <typename T>
+T read(const char*& data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return value;
+}
+
+void writeArg(Line& line, deferred::Tag tag, const char*& data) {
+  using deferred::Tag;
+  switch (tag) {
+    case Tag::boolean: line.text(read<bool>(data) ? "true" : "false"); break;
+    case Tag::character: line.text({data++, 1}); break;
+    case Tag::i8: line.number(read<std::int8_t>(data)); break;
+    case Tag::u8: line.number(read<std::uint8_t>(data)); break;
+    case Tag::i16: line.number(read<std::int16_t>(data)); break;
+    case Tag::u16: line.number(read<std::uint16_t>(data)); break;
+    case Tag::i32: line.number(read<std::int32_t>(data)); break;
+    case Tag::u32: line.number(read<std::uint32_t>(data)); break;
+    case Tag::i64: line.number(read<std::int64_t>(data)); break;
+    case Tag::u64: line.number(read<std::uint64_t>(data)); break;
+    case Tag::f32: line.number(read<float>(data)); break;
+    case Tag::f64: line.number(read<double>(data)); break;
+    case Tag::string: {
+      auto size = read<std::uint32_t>(data);
+      line.text({data, size});
+      data += size;
+      break;
+    }
+  }
+}
+
+// Substitutes the packed arguments into the fields of `format` in order, without their specs.
+void writePacked(Line& line, std::string_view format, const deferred::ArgsInfo& args,
+                 const char* data) {
+  std::size_t arg = 0;
+  for (std::size_t i = 0; i < format.size(); ++i) {
+    auto c = format[i];
+    if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c)
+      ++i;
+    else if (c == '{') {
+      auto end = format.find('}', i);
+      if (end == std::string_view::npos || arg == args.count) {
+        line.text(format.substr(i));
+        return;
+      }
+      writeArg(line, args.tags[arg++], data);
+      i = end;
+      continue;
+    }
+    line.text({&format[i], 1});
+  }
+}
+
+}  // namespace
+
+namespace cvs::logger {
+
+FlightRecorder::FlightRecorder(std::string_view n, const Recorder& config)
+    : name(n)
+    , mask(std::bit_ceil(std::max<std::uint64_t>(config.slots, 1)) - 1)
+    , slots(new Slot[mask + 1])
+    , lvl(config.level)
+    , dump_lvl(config.dump_level) {
+  for (auto& r : registry) {
+    FlightRecorder* none = nullptr;
+    if (r.compare_exchange_strong(none, this)) {
+      registration = &r;
+      return;
+    }
+  }
+  unregistered_cnt.fetch_add(1, std::memory_order_relaxed);
+}
+
+FlightRecorder::~FlightRecorder() { retire(); }
+
+void FlightRecorder::retire() {
+  if (std::exchange(retired, true))
+    return;
+  if (registration)
+    registration->store(nullptr, std::memory_order_release);
+  else
+    unregistered_cnt.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t FlightRecorder::unregistered() {
+  return unregistered_cnt.load(std::memory_order_relaxed);
+}
+
+void FlightRecorder::setLevels(Level level, Level dump_level) {
+  lvl.store(level, std::memory_order_relaxed);
+  dump_lvl.store(dump_level, std::memory_order_relaxed);
+}
+
+template <typename Fn>
+void FlightRecorder::read(std::uint64_t from, std::uint64_t to, Fn&& fn) const {
+  Message message;
+  for (auto index = from; index < to; ++index) {
+    auto& slot = slots[index & mask];
+    auto  seq  = 2 * index + 2;
+    if (slot.seq.load(std::memory_order_acquire) != seq)
+      continue;
+
+    message.timestamp   = slot.timestamp;
+    message.format      = slot.format;
+    message.args        = slot.args;
+    message.format_size = slot.format_size;
+    message.level       = slot.level;
+    message.size        = std::min<std::uint16_t>(slot.size, sizeof(message.data));
+    std::memcpy(message.data, slot.data, message.size);
+
+    // The slot was not overwritten while it was copied.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq)
+      fn(message);
+  }
+}
+
+void FlightRecorder::dump(
+    const std::function<void(Level, std::chrono::nanoseconds, std::string_view)>& sink) {
+  auto end  = head.load(std::memory_order_acquire);
+  auto from = dumped.load(std::memory_order_relaxed);
+  do {
+    if (from >= end)
+      return;
+  } while (!dumped.compare_exchange_weak(from, end, std::memory_order_relaxed));
+
+  read(std::max(from, end > capacity() ? end - capacity() : 0), end, [&](const Message& m) {
+    auto time = std::chrono::nanoseconds(m.timestamp);
+    if (!m.args) {
+      sink(m.level, time, m.text());
+      return;
+    }
+    try {
+      sink(m.level, time, m.args->format(m.formatString(), m.data));
+    }
+    catch (const std::exception& e) {
+      sink(m.level, time, e.what());
+    }
+  });
+}
+
+void FlightRecorder::dumpTo(int fd) const {
+  auto end  = head.load(std::memory_order_acquire);
+  auto from = std::max(dumped.load(std::memory_order_relaxed),
+                       end > capacity() ? end - capacity() : 0);
+
+  Line line;
+  read(from, end, [&](const Message& m) {
+    line.text("[");
+    line.number(m.timestamp / 1000000000);
+    line.text(".");
+    line.padded(std::uint64_t(m.timestamp % 1000000000 / 1000), 6);
+    line.text("] [");
+    line.text(name);
+    line.text("] [");
+    line.text(level_names[int(m.level)]);
+    line.text("] ");
+    if (m.args)
+      writePacked(line, m.formatString(), *m.args, m.data);
+    else
+      line.text(m.text());
+    line.write(fd);
+  });
+}
+
+void FlightRecorder::dumpAll(int fd) {
+  for (auto& r : registry) {
+    if (auto recorder = r.load(std::memory_order_acquire))
+      recorder->dumpTo(fd);
+  }
+
+  if (auto missing = unregistered_cnt.load(std::memory_order_relaxed)) {
+    Line line;
+    line.number(missing);
+    line.text(" flight recorders were not dumped, the registry is full.");
+    line.write(fd);
+  }
+}
+
+void installCrashHandler() {
+  static std::once_flag installed;
+  std::call_once(installed, [] {
+    struct sigaction action {};
+    action.sa_handler = onCrash;
+    sigemptyset(&action.sa_mask);
+    for (std::size_t i = 0; i < std::size(crash_signals); ++i)
+      sigaction(crash_signals[i], &action, &previous_actions[i]);
+  });
+}
+
+}  // namespace cvs::logger
@@ -0,0 +1,132 @@
+#include "../include/cvs/logger/stats.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Live threads with filtered-call slots and the counts of the exited ones, indexed by slot id.
+struct SlotRegistry {
+  std::mutex               mutex;
+  std::vector<void*>       threads;
+  std::vector<std::size_t> exited;
+  std::vector<std::size_t> free_ids;
+  std::size_t              next_id = 0;
+
+  // Never destroyed, threads may exit after the static destructors ran.
+  static SlotRegistry& instance() {
+    static auto registry = new SlotRegistry;
+    return *registry;
+  }
+};
+
+}  // namespace
+
+namespace cvs::logger {
+
+StatCounters::ThreadSlots::ThreadSlots() {
+  auto&           registry = SlotRegistry::instance();
+  std::lock_guard lock(registry.mutex);
+  registry.threads.push_back(this);
+}
+
+StatCounters::ThreadSlots::~ThreadSlots() {
+  auto&           registry = SlotRegistry::instance();
+  std::lock_guard lock(registry.mutex);
+  registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+  for (std::size_t id = 0; id < registry.exited.size(); ++id)
+    registry.exited[id] += load(id);
+  for (auto& chunk : chunks)
+    delete chunk.load(std::memory_order_relaxed);
+}
+
+StatCounters::ThreadSlots& StatCounters::ThreadSlots::create() {
+  thread_local ThreadSlots slots;
+  return slots;
+}
+
+StatCounters::ThreadSlots::Chunk* StatCounters::ThreadSlots::allocate(std::size_t index) {
+  auto chunk = new Chunk{};
+  // load() may read the chunk as soon as it is published.
+  auto&           registry = SlotRegistry::instance();
+  std::lock_guard lock(registry.mutex);
+  chunks[index].store(chunk, std::memory_order_release);
+  return chunk;
+}
+
+std::size_t StatCounters::ThreadSlots::load(std::size_t id) const {
+  auto chunk = chunks[id / chunk_size].load(std::memory_order_acquire);
+  return chunk ? (*chunk)[id % chunk_size].load(std::memory_order_relaxed) : 0;
+}
+
+void StatCounters::ThreadSlots::reset(std::size_t id) {
+  if (auto chunk = chunks[id / chunk_size].load(std::memory_order_acquire))
+    (*chunk)[id % chunk_size].store(0, std::memory_order_relaxed);
+}
+
+StatCounters::StatCounters()
+    : id([] {
+      auto&           registry = SlotRegistry::instance();
+      std::lock_guard lock(registry.mutex);
+      if (!registry.free_ids.empty()) {
+        auto id = registry.free_ids.back();
+        registry.free_ids.pop_back();
+        return id;
+      }
+      if (registry.next_id == ThreadSlots::max_ids)
+        return ThreadSlots::max_ids;
+      registry.exited.push_back(0);
+      return registry.next_id++;
+    }()) {}
+
+StatCounters::~StatCounters() {
+  if (id == ThreadSlots::max_ids)
+    return;
+
+  // The slots of the id are cleared for the next StatCounters that takes it.
+  auto&           registry = SlotRegistry::instance();
+  std::lock_guard lock(registry.mutex);
+  for (auto thread : registry.threads)
+    static_cast<ThreadSlots*>(thread)->reset(id);
+  registry.exited[id] = 0;
+  registry.free_ids.push_back(id);
+}
+
+LoggerStats& LoggerStats::operator+=(const LoggerStats& other) {
+  emitted += other.emitted;
+  filtered += other.filtered;
+  bytes += other.bytes;
+  dropped += other.dropped;
+  sink_time += other.sink_time;
+  images += other.images;
+  image_bytes += other.image_bytes;
+  return *this;
+}
+
+std::size_t StatCounters::shardIndex() {
+  static std::atomic_size_t next{0};
+  return next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+}
+
+LoggerStats StatCounters::load() const {
+  LoggerStats stats;
+  for (auto& s : shards) {
+    stats.filtered += s.filtered.load(std::memory_order_relaxed);
+    stats.emitted += s.emitted.load(std::memory_order_relaxed);
+    stats.bytes += s.bytes.load(std::memory_order_relaxed);
+    stats.sink_time += std::chrono::nanoseconds(s.sink_ns.load(std::memory_order_relaxed));
+    stats.images += s.images.load(std::memory_order_relaxed);
+    stats.image_bytes += s.image_bytes.load(std::memory_order_relaxed);
+  }
+  if (id < ThreadSlots::max_ids) {
+    auto&           registry = SlotRegistry::instance();
+    std::lock_guard lock(registry.mutex);
+    stats.filtered += registry.exited[id];
+    for (auto thread : registry.threads)
+      stats.filtered += static_cast<const ThreadSlots*>(thread)->load(id);
+  }
+  return stats;
+}
+
+}  // namespace cvs::logger
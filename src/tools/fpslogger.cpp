@@ -2,63 +2,278 @@
 
 #include <fmt/chrono.h>
 #include "../include/cvs/logger/logging.hpp"
+#include "reporter.hpp"
 
-#include <list>
-#include <shared_mutex>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <vector>
 
 using namespace std::chrono_literals;
 
 using duration   = cvs::logger::tools::FpsLogger::duration;
 using time_point = cvs::logger::tools::FpsLogger::time_point;
+using rep        = duration::rep;
+
+namespace {
+
+double milliseconds(cvs::logger::tools::Histogram::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+}  // namespace
 
 namespace cvs::logger::tools {
 
-class FpsLogger::Private {
+class FpsLogger::Private : public Reporter::Source {
  public:
-  static double   fps(const duration&, std::size_t counter = 2);
-  static duration avrTime(const duration&, std::size_t counter = 2);
+  // Value of prev_frame_point before the first frame.
+  static constexpr rep no_frame = std::numeric_limits<rep>::min();
+
+  static double fps(const duration&, std::size_t counter = 2);
 
   void update(duration last_dur);
+  void   countFrame(rep frame_time);
+  double windowFps(rep now) const;
+  // Writes the report of the period ending at `now` and starts the next one.
+  void reportPeriod(rep now);
+
+  time_point report(time_point now, bool force) override;
+
+  std::atomic_bool started{false};
+  std::atomic_bool autolog{true};
+
+  std::atomic<rep> prev_frame_point{no_frame};
+
+  std::atomic<rep>    report_period{duration(10min).count()};
+  std::atomic<rep>    report_start{0};
+  std::atomic_size_t  report_start_cnt{0};
+  std::atomic<rep>    total_dur{0};
+  std::atomic_size_t  total_cnt{0};
+  std::atomic<double> last_fps{0};
+  std::atomic<double> smma_fps{0};
+  std::atomic<double> ro{0.1};
+
+  Histogram total_hist;
+  Histogram period_hist;
+
+  // Every bucket holds the index of its time slot in the upper bits and its frames in the lower.
+  static constexpr unsigned      count_bits = 24;
+  static constexpr std::uint64_t count_mask = (std::uint64_t(1) << count_bits) - 1;
+  static constexpr std::uint64_t slot_mask  = (std::uint64_t(1) << (64 - count_bits)) - 1;
+
+  // Time of the first frame counted in the window.
+  std::atomic<rep> window_start{no_frame};
+  std::atomic<rep> bucket_width{duration(5s).count() / rep(window_buckets)};
+
+  std::array<std::atomic_uint64_t, window_buckets> window{};
+
+  cvs::logger::LoggerPtr logger;
+
+  // Keep the reporter alive until the last logger is destroyed.
+  std::shared_ptr<Reporter>       reporter;
+  std::shared_ptr<CombinedReport> combined;
+};
+
+/**
+ * Combined report of the live FpsLoggers, written by the Reporter thread like the reports of the
+ * loggers.
+ */
+class FpsLogger::CombinedReport : public Reporter::Source {
+ public:
+  static std::shared_ptr<CombinedReport> instance() {
+    static auto combined = []() {
+      auto c = std::make_shared<CombinedReport>();
+      Reporter::instance()->add(c);
+      return c;
+    }();
+    return combined;
+  }
 
-  bool started  = false;
-  bool autolog  = true;
-  bool use_lock = false;
+  void add(const std::shared_ptr<Private>& logger) {
+    std::lock_guard lock(mutex);
+    loggers.push_back({logger, 0});
+  }
 
-  time_point prev_frame_point;
+  // Waits for a running report.
+  void remove(const Private* logger) {
+    std::lock_guard lock(mutex);
+    auto last = std::remove_if(loggers.begin(), loggers.end(), [logger](const Entry& e) {
+      auto l = e.logger.lock();
+      return !l || l.get() == logger;
+    });
+    loggers.erase(last, loggers.end());
+  }
 
-  duration report_period = 10min;
+  void set(duration p, std::string_view name) {
+    auto l = cvs::logger::LoggerFactory::getLogger(name);
+    {
+      std::lock_guard lock(mutex);
+      period = p;
+      logger = std::move(l);
+      start  = clock::now();
+    }
+    Reporter::instance()->wake();
+  }
 
-  duration    report_dur;
-  std::size_t report_cnt = 0;
-  duration    total_dur;
-  std::size_t total_cnt = 0;
+  time_point report(time_point now, bool force) override;
 
-  double last_fps = 0;
-  double smma_fps = 0;
-  double ro       = 0.1;
+ private:
+  struct Entry {
+    std::weak_ptr<Private> logger;
+    // Frames counted by the previous combined report.
+    std::size_t combined_cnt;
+  };
 
-  cvs::logger::LoggerPtr    logger;
-  mutable std::shared_mutex update_mutex;
+  std::mutex         mutex;
+  std::vector<Entry> loggers;
+
+  duration               period{0};
+  time_point             start;
+  cvs::logger::LoggerPtr logger;
 };
 
+FpsLogger::time_point FpsLogger::Private::report(time_point now, bool force) {
+  auto period = duration(report_period.load(std::memory_order_relaxed));
+  // A zero period disables the periodic reports.
+  if (period.count() <= 0 || !started.load(std::memory_order_relaxed) ||
+      !autolog.load(std::memory_order_relaxed))
+    return time_point::max();
+
+  period   = std::max(period, Reporter::min_period);
+  auto due = time_point(duration(report_start.load(std::memory_order_relaxed))) + period;
+  if (due > now && !force)
+    return due;
+
+  reportPeriod(now.time_since_epoch().count());
+  return now + period;
+}
+
+FpsLogger::time_point FpsLogger::CombinedReport::report(time_point now, bool force) {
+  std::lock_guard lock(mutex);
+  if (period.count() <= 0)
+    return time_point::max();
+
+  auto p = std::max(period, Reporter::min_period);
+  if (start + p > now && !force)
+    return start + p;
+
+  Histogram   hist;
+  std::size_t frames  = 0;
+  std::size_t started = 0;
+  for (auto& entry : loggers) {
+    auto l = entry.logger.lock();
+    if (!l || !l->started.load(std::memory_order_relaxed))
+      continue;
+
+    auto total = l->total_cnt.load(std::memory_order_relaxed);
+    // The counters of a cleared logger start over.
+    frames += total - std::min(entry.combined_cnt, total);
+    entry.combined_cnt = total;
+    hist.merge(l->total_hist);
+    ++started;
+  }
+
+  LOG_DEBUG(logger,
+            "{} FPS loggers, {} frames for last {}, {:.2f} FPS in total. Frame time p50 {:.2f} ms, "
+            "p99 {:.2f} ms, max {:.2f} ms since start.",
+            started, frames, duration_cast<std::chrono::milliseconds>(now - start),
+            frames / std::chrono::duration<double>(now - start).count(),
+            milliseconds(hist.percentile(50)), milliseconds(hist.percentile(99)),
+            milliseconds(hist.max()));
+
+  start = now;
+  return now + p;
+}
+
 void FpsLogger::Private::update(duration last_dur) {
+  total_dur.fetch_add(last_dur.count(), std::memory_order_relaxed);
+  total_hist.record(last_dur);
+  period_hist.record(last_dur);
+  // Frames of one timestamp from different threads don't define a rate.
+  if (last_dur.count() == 0)
+    return;
+
   auto f = fps(last_dur);
-  if (use_lock)
-    update_mutex.lock();
-  total_dur += last_dur;
-  last_fps = f;
-  smma_fps = (1 - ro) * smma_fps + ro * f;
-  ++total_cnt;
-  if (use_lock)
-    update_mutex.unlock();
+  last_fps.store(f, std::memory_order_relaxed);
+
+  auto r    = ro.load(std::memory_order_relaxed);
+  auto smma = smma_fps.load(std::memory_order_relaxed);
+  while (!smma_fps.compare_exchange_weak(smma, (1 - r) * smma + r * f, std::memory_order_relaxed))
+    ;
 }
 
-double FpsLogger::Private::fps(const duration& dur, std::size_t counter) {
-  return (counter - 1) / duration_cast<std::chrono::duration<double>>(dur).count();
+void FpsLogger::Private::reportPeriod(rep now) {
+  auto start  = report_start.exchange(now, std::memory_order_relaxed);
+  auto total  = total_cnt.load(std::memory_order_relaxed);
+  auto before = report_start_cnt.exchange(total, std::memory_order_relaxed);
+  // Intervals recorded meanwhile go to this report or the next one, none are lost.
+  Histogram period;
+  period.drain(period_hist);
+  if (total > before) {
+    LOG_DEBUG(logger,
+              "FPS for last {} frames is {:.2f}, for last {} is {:.2f}. Frame time p50 {:.2f} ms, "
+              "p90 {:.2f} ms, p99 {:.2f} ms, p99.9 {:.2f} ms, max {:.2f} ms.",
+              total - before, fps(duration(now - start), total - before + 1),
+              duration_cast<std::chrono::milliseconds>(
+                  duration(bucket_width.load(std::memory_order_relaxed) * rep(window_buckets))),
+              windowFps(now),
+              milliseconds(period.percentile(50)), milliseconds(period.percentile(90)),
+              milliseconds(period.percentile(99)), milliseconds(period.percentile(99.9)),
+              milliseconds(period.max()));
+  }
+}
+
+void FpsLogger::Private::countFrame(rep frame_time) {
+  if (window_start.load(std::memory_order_relaxed) == no_frame) {
+    auto none = no_frame;
+    window_start.compare_exchange_strong(none, frame_time, std::memory_order_relaxed);
+  }
+
+  auto  slot   = std::uint64_t(frame_time / bucket_width.load(std::memory_order_relaxed));
+  auto& bucket = window[slot % window_buckets];
+  slot &= slot_mask;
+
+  auto value = bucket.load(std::memory_order_relaxed);
+  while (true) {
+    auto bucket_slot = value >> count_bits;
+    std::uint64_t next;
+    if (bucket_slot == slot)
+      next = (value & count_mask) == count_mask ? value : value + 1;
+    else if (((bucket_slot - slot) & slot_mask) < slot_mask / 2)
+      return;  // A late frame of a slot already reused for a newer one.
+    else
+      next = (slot << count_bits) | 1;
+    if (bucket.compare_exchange_weak(value, next, std::memory_order_relaxed))
+      return;
+  }
+}
+
+double FpsLogger::Private::windowFps(rep now) const {
+  auto width = bucket_width.load(std::memory_order_relaxed);
+  auto slot  = std::uint64_t(now / width) & slot_mask;
+
+  std::uint64_t frames = 0;
+  for (auto& bucket : window) {
+    auto value = bucket.load(std::memory_order_relaxed);
+    if (((slot - (value >> count_bits)) & slot_mask) < window_buckets)
+      frames += value & count_mask;
+  }
+
+  // The current bucket is only partly elapsed, and the window may be longer than the run.
+  auto first = window_start.load(std::memory_order_relaxed);
+  if (first == no_frame)
+    return 0;
+  auto covered = std::min<rep>(width * rep(window_buckets - 1) + now % width, now - first);
+  if (covered <= 0)
+    return 0;
+  return frames / duration_cast<std::chrono::duration<double>>(duration(covered)).count();
 }
 
-duration FpsLogger::Private::avrTime(const duration& dur, std::size_t counter) {
-  return dur / (counter - 1);
+double FpsLogger::Private::fps(const duration& dur, std::size_t counter) {
+  return (counter - 1) / duration_cast<std::chrono::duration<double>>(dur).count();
 }
 
 }  // namespace cvs::logger::tools
@@ -70,100 +285,150 @@ FpsLogger::FpsLogger(std::string_view name)
   if (name.empty())
     LOG_GLOB_CRITICAL("The FpsLogger name must not be empty.");
 
-  m->logger = cvs::logger::LoggerFactory::getLogger(name);
+  m->logger   = cvs::logger::LoggerFactory::getLogger(name);
+  m->reporter = Reporter::instance();
+  m->combined = CombinedReport::instance();
+  m->reporter->add(m);
+  m->combined->add(m);
 }
 
-FpsLogger::~FpsLogger() { stop(); }
+FpsLogger::~FpsLogger() {
+  stop();
+  m->reporter->remove(m.get());
+  m->combined->remove(m.get());
+}
 
-void   FpsLogger::setRo(double ro) { m->ro = ro; }
-double FpsLogger::ro() const { return m->ro; }
+void FpsLogger::setCombinedReport(duration period, std::string_view name) {
+  CombinedReport::instance()->set(period, name);
+}
 
-void            FpsLogger::setReportDuration(duration d) { m->report_period = std::move(d); }
-const duration& FpsLogger::reportDuration() const { return m->report_period; }
+void FpsLogger::flushReports() { Reporter::instance()->flush(); }
 
-void FpsLogger::setAutoreport(bool enable) { m->autolog = enable; }
-bool FpsLogger::autoreport() const { return m->autolog; }
+void   FpsLogger::setRo(double ro) { m->ro.store(ro, std::memory_order_relaxed); }
+double FpsLogger::ro() const { return m->ro.load(std::memory_order_relaxed); }
+
+void FpsLogger::setReportDuration(duration d) {
+  m->report_period.store(d.count(), std::memory_order_relaxed);
+  m->reporter->wake();
+}
+duration FpsLogger::reportDuration() const {
+  return duration(m->report_period.load(std::memory_order_relaxed));
+}
+
+void FpsLogger::setAutoreport(bool enable) {
+  m->autolog.store(enable, std::memory_order_relaxed);
+  m->reporter->wake();
+}
+bool FpsLogger::autoreport() const { return m->autolog.load(std::memory_order_relaxed); }
 
 void FpsLogger::start() {
-  if (!m->started) {
-    m->started = true;
+  if (!m->started.exchange(true)) {
     clear();
+    m->reporter->wake();
   }
 }
 
-bool FpsLogger::started() const { return m->started; }
+bool FpsLogger::started() const { return m->started.load(std::memory_order_relaxed); }
 
 void FpsLogger::stop() {
-  if (m->started) {
-    m->started = false;
-
-    if (m->autolog) {
-      LOG_INFO(m->logger, "{} frames for {}. Average FPS: {:.2f}.", m->total_cnt,
-               duration_cast<std::chrono::milliseconds>(m->total_dur), fps());
+  if (m->started.exchange(false)) {
+    if (autoreport()) {
+      auto& hist = m->total_hist;
+      LOG_INFO(m->logger,
+               "{} frames for {}. Average FPS: {:.2f}. Frame time p50 {:.2f} ms, p99 {:.2f} ms, "
+               "max {:.2f} ms.",
+               framesCount(),
+               duration_cast<std::chrono::milliseconds>(
+                   duration(m->total_dur.load(std::memory_order_relaxed))),
+               fps(), milliseconds(hist.percentile(50)), milliseconds(hist.percentile(99)),
+               milliseconds(hist.max()));
     }
   }
 }
 
 double FpsLogger::fps() const {
-  if (m->total_dur.count())
-    return m->fps(m->total_dur, m->total_cnt);
+  auto dur = duration(m->total_dur.load(std::memory_order_relaxed));
+  if (dur.count())
+    return m->fps(dur, framesCount());
 
   return -1;
 }
 
-double FpsLogger::smmaFps() const { return m->smma_fps; }
+double FpsLogger::smmaFps() const { return m->smma_fps.load(std::memory_order_relaxed); }
 
-double FpsLogger::lastFps() const { return m->last_fps; }
+double FpsLogger::lastFps() const { return m->last_fps.load(std::memory_order_relaxed); }
 
 FpsLogger::TotalStat FpsLogger::getStat() const {
-  if (m->use_lock)
-    m->update_mutex.lock_shared();
-  TotalStat res{m->last_fps, m->smma_fps, fps(), m->total_cnt};
-  if (m->use_lock)
-    m->update_mutex.unlock_shared();
-  return res;
+  auto& hist = m->total_hist;
+  return TotalStat{lastFps(),
+                   smmaFps(),
+                   fps(),
+                   framesCount(),
+                   duration_cast<duration>(hist.percentile(50)),
+                   duration_cast<duration>(hist.percentile(90)),
+                   duration_cast<duration>(hist.percentile(99)),
+                   duration_cast<duration>(hist.percentile(99.9)),
+                   duration_cast<duration>(hist.max()),
+                   windowFps()};
 }
 
-void FpsLogger::setUseLock(bool use_lock) { m->use_lock = use_lock; }
+void FpsLogger::setWindow(duration d) {
+  m->bucket_width.store(std::max<rep>(d.count() / rep(window_buckets), 1),
+                        std::memory_order_relaxed);
+  for (auto& bucket : m->window)
+    bucket.store(0, std::memory_order_relaxed);
+  m->window_start.store(Private::no_frame, std::memory_order_relaxed);
+}
 
-void FpsLogger::newFrame(time_point frame_time) {
-  if (!m->started)
-    return;
+duration FpsLogger::window() const {
+  return duration(m->bucket_width.load(std::memory_order_relaxed) * rep(window_buckets));
+}
 
-  if (m->total_cnt) {
-    auto last_dur = frame_time - m->prev_frame_point;
+double FpsLogger::windowFps() const {
+  return m->windowFps(clock::now().time_since_epoch().count());
+}
 
-    m->update(last_dur);
+const Histogram& FpsLogger::histogram() const { return m->total_hist; }
 
-    if (m->autolog) {
-      LOG_TRACE(m->logger, "Frame {}. Current FPS {:.2f}. SMMA FPS {:.2f}. Mean FPS {:.2f}",
-                m->total_cnt, m->last_fps, m->smma_fps, fps());
+void FpsLogger::setUseLock(bool) {}
 
-      m->report_dur += last_dur;
-      ++m->report_cnt;
-      if (m->report_dur >= m->report_period) {
-        LOG_DEBUG(m->logger, "FPS for last {} frames is {:.2f}.", m->report_cnt,
-                  m->fps(m->report_dur, m->report_cnt));
+void FpsLogger::newFrame(time_point frame_time) {
+  if (!m->started.load(std::memory_order_relaxed))
+    return;
 
-        m->report_cnt = 0;
-        m->report_dur = duration{0};
-      }
-    }
-  } else
-    ++m->total_cnt;
+  auto now  = frame_time.time_since_epoch().count();
+  auto cnt  = m->total_cnt.fetch_add(1, std::memory_order_relaxed) + 1;
+  m->countFrame(now);
+  auto prev = m->prev_frame_point.exchange(now, std::memory_order_relaxed);
+  if (prev == Private::no_frame)
+    return;
+
+  // Producers may record their frames out of order, such intervals are counted as zero.
+  m->update(duration(std::max<rep>(now - prev, 0)));
+
+  if (!autoreport())
+    return;
 
-  m->prev_frame_point = frame_time;
+  // Periodic reports are written by the Reporter thread.
+  LOG_TRACE(m->logger, "Frame {}. Current FPS {:.2f}. SMMA FPS {:.2f}. Mean FPS {:.2f}", cnt,
+            lastFps(), smmaFps(), fps());
 }
 
 void FpsLogger::clear() {
-  m->prev_frame_point = clock::now();
-  m->report_dur       = duration{0};
-  m->report_cnt       = 0;
-  m->total_dur        = duration{0};
-  m->total_cnt        = 0;
-  m->smma_fps         = 0;
-  m->last_fps         = 0;
+  auto now = clock::now().time_since_epoch().count();
+  m->prev_frame_point.store(Private::no_frame, std::memory_order_relaxed);
+  m->report_start.store(now, std::memory_order_relaxed);
+  m->report_start_cnt.store(0, std::memory_order_relaxed);
+  m->total_dur.store(0, std::memory_order_relaxed);
+  m->total_cnt.store(0, std::memory_order_relaxed);
+  m->smma_fps.store(0, std::memory_order_relaxed);
+  m->last_fps.store(0, std::memory_order_relaxed);
+  m->total_hist.clear();
+  m->period_hist.clear();
+  for (auto& bucket : m->window)
+    bucket.store(0, std::memory_order_relaxed);
+  m->window_start.store(Private::no_frame, std::memory_order_relaxed);
 }
 
-std::size_t FpsLogger::framesCount() const { return m->total_cnt; }
+std::size_t FpsLogger::framesCount() const { return m->total_cnt.load(std::memory_order_relaxed); }
 }  // namespace cvs::logger::tools
@@ -0,0 +1,102 @@
+#include "../include/cvs/logger/tools/histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+
+using cvs::logger::tools::Histogram;
+
+constexpr std::uint64_t sub_buckets = std::uint64_t(1) << Histogram::sub_bucket_bits;
+
+void updateMax(std::atomic_uint64_t& max_value, std::uint64_t value) {
+  auto current = max_value.load(std::memory_order_relaxed);
+  while (current < value &&
+         !max_value.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    ;
+}
+
+}  // namespace
+
+namespace cvs::logger::tools {
+
+std::size_t Histogram::bucketIndex(std::uint64_t value) {
+  // Values below sub_buckets have buckets of their own.
+  if (value < sub_buckets)
+    return std::size_t(value);
+
+  auto exponent = unsigned(std::bit_width(value)) - 1;
+  if (exponent >= max_bits)
+    return bucket_count - 1;
+  auto shift = exponent - sub_bucket_bits;
+  return std::size_t(sub_buckets * (shift + 1) + ((value >> shift) - sub_buckets));
+}
+
+std::uint64_t Histogram::bucketHigh(std::size_t index) {
+  if (index < sub_buckets)
+    return index;
+
+  auto shift = index / sub_buckets - 1;
+  auto sub   = index % sub_buckets;
+  return ((sub_buckets + sub + 1) << shift) - 1;
+}
+
+void Histogram::record(duration d) {
+  auto value = std::uint64_t(std::max<duration::rep>(d.count(), 0));
+  buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  updateMax(max_value, value);
+}
+
+std::uint64_t Histogram::count() const {
+  std::uint64_t total = 0;
+  for (auto& b : buckets)
+    total += b.load(std::memory_order_relaxed);
+  return total;
+}
+
+Histogram::duration Histogram::max() const {
+  return duration(max_value.load(std::memory_order_relaxed));
+}
+
+Histogram::duration Histogram::percentile(double p) const {
+  auto total = count();
+  if (total == 0)
+    return duration(0);
+
+  auto target = std::max<std::uint64_t>(1, std::uint64_t(std::ceil(total * p / 100)));
+  auto max    = max_value.load(std::memory_order_relaxed);
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < bucket_count; ++i) {
+    seen += buckets[i].load(std::memory_order_relaxed);
+    if (seen >= target)
+      return duration(std::min(bucketHigh(i), max));
+  }
+  return duration(max);
+}
+
+void Histogram::merge(const Histogram& other) {
+  for (std::size_t i = 0; i < bucket_count; ++i) {
+    if (auto cnt = other.buckets[i].load(std::memory_order_relaxed))
+      buckets[i].fetch_add(cnt, std::memory_order_relaxed);
+  }
+  updateMax(max_value, other.max_value.load(std::memory_order_relaxed));
+}
+
+void Histogram::drain(Histogram& other) {
+  for (std::size_t i = 0; i < bucket_count; ++i) {
+    if (other.buckets[i].load(std::memory_order_relaxed))
+      buckets[i].fetch_add(other.buckets[i].exchange(0, std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+  }
+  updateMax(max_value, other.max_value.exchange(0, std::memory_order_relaxed));
+}
+
+void Histogram::clear() {
+  for (auto& b : buckets)
+    b.store(0, std::memory_order_relaxed);
+  max_value.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace cvs::logger::tools
@@ -0,0 +1,103 @@
+#include "reporter.hpp"
+
+#include <algorithm>
+
+namespace cvs::logger::tools {
+
+std::shared_ptr<Reporter> Reporter::instance() {
+  static auto reporter = std::make_shared<Reporter>();
+  return reporter;
+}
+
+Reporter::~Reporter() {
+  {
+    std::lock_guard lock(mutex);
+    stop = true;
+  }
+  cv.notify_one();
+  if (thread.joinable())
+    thread.join();
+}
+
+void Reporter::add(std::weak_ptr<Source> source) {
+  std::lock_guard lock(mutex);
+  sources.push_back(std::move(source));
+}
+
+void Reporter::remove(const Source* source) {
+  std::unique_lock lock(mutex);
+  auto last = std::remove_if(sources.begin(), sources.end(), [source](const auto& s) {
+    auto l = s.lock();
+    return !l || l.get() == source;
+  });
+  sources.erase(last, sources.end());
+  reported_cv.wait(lock, [this, source]() { return reporting != source; });
+}
+
+void Reporter::wake() {
+  {
+    std::lock_guard lock(mutex);
+    wakeLocked();
+  }
+  cv.notify_one();
+}
+
+void Reporter::flush() {
+  std::unique_lock lock(mutex);
+  auto             request = ++flush_requested;
+  wakeLocked();
+  cv.notify_one();
+  flushed_cv.wait(lock, [this, request]() { return flushed >= request; });
+}
+
+void Reporter::wakeLocked() {
+  woken = true;
+  if (!thread.joinable())
+    thread = std::thread([this]() { run(); });
+}
+
+void Reporter::run() {
+  std::unique_lock lock(mutex);
+  while (!stop) {
+    auto now   = clock::now();
+    auto next  = time_point::max();
+    auto flush = flush_requested;
+    auto force = flushed < flush;
+
+    // The reports write to the loggers, so they run unlocked on a copy of the list. Sources
+    // removed while another report ran are skipped.
+    auto snapshot   = sources;
+    auto registered = [this](const std::weak_ptr<Source>& s) {
+      return std::any_of(sources.begin(), sources.end(), [&s](const auto& r) {
+        return !r.owner_before(s) && !s.owner_before(r);
+      });
+    };
+    for (auto& s : snapshot) {
+      auto source = s.lock();
+      if (!source || !registered(s))
+        continue;
+      reporting = source.get();
+      lock.unlock();
+      auto due = source->report(now, force);
+      source.reset();
+      lock.lock();
+      reporting = nullptr;
+      reported_cv.notify_all();
+      next = std::min(next, due);
+    }
+
+    if (force) {
+      flushed = flush;
+      flushed_cv.notify_all();
+    }
+
+    woken     = false;
+    auto pred = [this]() { return stop || woken; };
+    if (next == time_point::max())
+      cv.wait(lock, pred);
+    else
+      cv.wait_until(lock, next, pred);
+  }
+}
+
+}  // namespace cvs::logger::tools
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cvs::logger::tools {
+
+/**
+ * Thread that writes the periodic reports of the FpsLoggers and StageTrackers, so the measured
+ * threads don't pay for them. The thread sleeps until the next report of any source is due.
+ */
+class Reporter {
+ public:
+  using clock      = std::chrono::steady_clock;
+  using duration   = clock::duration;
+  using time_point = clock::time_point;
+
+  class Source {
+   public:
+    virtual ~Source() = default;
+
+    /**
+     * Writes the report if it is due at `now`, or with `force` if reports are enabled. Returns when
+     * the next report is due, time_point::max() if reports are disabled.
+     */
+    virtual time_point report(time_point now, bool force) = 0;
+  };
+
+  // Shorter periods are extended, so the thread does not spin.
+  static constexpr duration min_period = std::chrono::milliseconds(1);
+
+  static std::shared_ptr<Reporter> instance();
+
+  ~Reporter();
+
+  void add(std::weak_ptr<Source>);
+  // Waits for a running report of the source.
+  void remove(const Source*);
+
+  // The schedule of a source changed. Starts the thread on the first call.
+  void wake();
+  // Makes the thread write the enabled reports now, due or not, and waits for them.
+  void flush();
+
+ private:
+  void wakeLocked();
+  void run();
+
+  std::mutex                         mutex;
+  std::condition_variable            cv;
+  std::condition_variable            flushed_cv;
+  std::condition_variable            reported_cv;
+  std::vector<std::weak_ptr<Source>> sources;
+  const Source*                      reporting       = nullptr;  // Runs report() unlocked.
+  bool                               woken           = false;
+  bool                               stop            = false;
+  std::uint64_t                      flush_requested = 0;
+  std::uint64_t                      flushed         = 0;
+
+  std::thread thread;
+};
+
+}  // namespace cvs::logger::tools
@@ -0,0 +1,348 @@
+#include "../include/cvs/logger/tools/stagetracker.hpp"
+
+#include "../include/cvs/logger/logging.hpp"
+#include "../include/cvs/logger/tools/histogram.hpp"
+#include "reporter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+using namespace std::chrono_literals;
+
+using duration   = cvs::logger::tools::StageTracker::duration;
+using time_point = cvs::logger::tools::StageTracker::time_point;
+using rep        = duration::rep;
+
+namespace {
+
+using cvs::logger::tools::Histogram;
+using cvs::logger::tools::StageTracker;
+
+// Innermost timed scope of the thread.
+thread_local StageTracker::Scope* current_scope = nullptr;
+
+double milliseconds(duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+struct Accumulator {
+  Histogram        hist;
+  std::atomic<rep> sum{0};
+};
+
+// Written by one thread only, read by the reports. The data of exited threads is merged into one
+// written under the tracker mutex.
+struct ThreadData {
+  std::array<std::atomic<Accumulator*>, StageTracker::max_stages> stages{};
+
+  ~ThreadData() {
+    for (auto& s : stages)
+      delete s.load(std::memory_order_relaxed);
+  }
+
+  Accumulator& at(std::size_t stage) {
+    auto acc = stages[stage].load(std::memory_order_relaxed);
+    if (!acc) {
+      acc = new Accumulator;
+      stages[stage].store(acc, std::memory_order_release);
+    }
+    return *acc;
+  }
+};
+
+struct StageInfo {
+  std::string      name;
+  std::size_t      hash = 0;
+  std::atomic_long parent{-1};
+};
+
+}  // namespace
+
+namespace cvs::logger::tools {
+
+class StageTracker::Private : public Reporter::Source,
+                              public std::enable_shared_from_this<StageTracker::Private> {
+ public:
+  ThreadData& threadData();
+  // Moves the stats of an exiting thread into `exited` and frees its data.
+  void release(ThreadData* data);
+
+  void add(std::size_t stage, duration d);
+  void setParent(std::size_t stage, std::size_t parent);
+
+  std::vector<StageStat> collect(bool drain);
+  // Writes the report of the stats since the previous one.
+  std::vector<StageStat> writeReport();
+  std::string            path(std::size_t stage) const;
+
+  time_point report(time_point now, bool force) override;
+
+  const std::uint64_t uid = next_uid.fetch_add(1, std::memory_order_relaxed);
+
+  // Slots below stage_count are immutable except for the parent.
+  std::array<StageInfo, max_stages> stages;
+  std::atomic_size_t                stage_count{0};
+
+  std::atomic<rep> frame_budget{0};
+  std::atomic<rep> report_period{duration(10min).count()};
+  std::atomic<rep> report_start{clock::now().time_since_epoch().count()};
+  std::atomic_bool autolog{true};
+
+  cvs::logger::LoggerPtr logger;
+  // Keeps the reporter alive until the last tracker is destroyed.
+  std::shared_ptr<Reporter> reporter;
+
+  // Serialises registration, the list of threads and the reports.
+  std::mutex                               mutex;
+  std::vector<std::unique_ptr<ThreadData>> threads;
+  ThreadData                               exited;  // Stats of the threads that exited.
+
+ private:
+  static std::atomic_uint64_t next_uid;
+};
+
+std::atomic_uint64_t StageTracker::Private::next_uid{1};
+
+ThreadData& StageTracker::Private::threadData() {
+  struct Entry {
+    std::uint64_t          uid;
+    ThreadData*            data;
+    std::weak_ptr<Private> tracker;
+  };
+  // The data of the thread goes back to the trackers still alive when the thread exits.
+  struct Cache {
+    std::vector<Entry> entries;
+
+    ~Cache() {
+      for (auto& entry : entries) {
+        if (auto tracker = entry.tracker.lock())
+          tracker->release(entry.data);
+      }
+    }
+  };
+  // Trackers are told apart by uid, so entries of destroyed trackers are never matched. They are
+  // dropped when the thread records to a tracker for the first time.
+  thread_local Cache cache;
+  for (auto& entry : cache.entries) {
+    if (entry.uid == uid)
+      return *entry.data;
+  }
+  std::erase_if(cache.entries, [](const Entry& e) { return e.tracker.expired(); });
+
+  std::lock_guard lock(mutex);
+  threads.push_back(std::make_unique<ThreadData>());
+  cache.entries.push_back({uid, threads.back().get(), weak_from_this()});
+  return *threads.back();
+}
+
+void StageTracker::Private::release(ThreadData* data) {
+  std::lock_guard lock(mutex);
+  for (std::size_t i = 0; i < max_stages; ++i) {
+    auto acc = data->stages[i].load(std::memory_order_relaxed);
+    if (!acc)
+      continue;
+    // Only the accumulators of recorded stages are allocated for the exited threads.
+    auto& total = exited.at(i);
+    total.hist.drain(acc->hist);
+    total.sum.fetch_add(acc->sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  std::erase_if(threads, [data](const std::unique_ptr<ThreadData>& t) { return t.get() == data; });
+}
+
+void StageTracker::Private::add(std::size_t stage, duration d) {
+  auto& acc = threadData().at(stage);
+  acc.hist.record(d);
+  acc.sum.fetch_add(d.count(), std::memory_order_relaxed);
+}
+
+time_point StageTracker::Private::report(time_point now, bool force) {
+  auto period = duration(report_period.load(std::memory_order_relaxed));
+  // A zero period disables the periodic reports.
+  if (period.count() <= 0 || !autolog.load(std::memory_order_relaxed))
+    return time_point::max();
+
+  period   = std::max(period, Reporter::min_period);
+  auto due = time_point(duration(report_start.load(std::memory_order_relaxed))) + period;
+  if (due > now && !force)
+    return due;
+
+  report_start.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+  writeReport();
+  return now + period;
+}
+
+std::vector<StageTracker::StageStat> StageTracker::Private::writeReport() {
+  auto stats = collect(true);
+  for (auto& stat : stats) {
+    if (stat.count == 0)
+      continue;
+    LOG_DEBUG(logger,
+              "Stage {}: {} calls, mean {:.2f} ms, p50 {:.2f} ms, p90 {:.2f} ms, p99 {:.2f} ms, "
+              "max {:.2f} ms, {:.1f}% of the frame.",
+              stat.path, stat.count, milliseconds(stat.mean), milliseconds(stat.p50),
+              milliseconds(stat.p90), milliseconds(stat.p99), milliseconds(stat.max),
+              stat.share * 100);
+  }
+  return stats;
+}
+
+void StageTracker::Private::setParent(std::size_t stage, std::size_t parent) {
+  if (stage == parent)
+    return;
+  // The first enclosing stage seen is kept.
+  long none = -1;
+  stages[stage].parent.compare_exchange_strong(none, long(parent), std::memory_order_relaxed);
+}
+
+std::string StageTracker::Private::path(std::size_t stage) const {
+  std::string result = stages[stage].name;
+  // The depth is limited in case stages were nested both ways on different threads.
+  auto parent = stages[stage].parent.load(std::memory_order_relaxed);
+  for (std::size_t depth = 0; parent >= 0 && depth < max_stages; ++depth) {
+    result = stages[std::size_t(parent)].name + "/" + result;
+    parent = stages[std::size_t(parent)].parent.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+std::vector<StageTracker::StageStat> StageTracker::Private::collect(bool drain) {
+  std::lock_guard lock(mutex);
+
+  auto count = stage_count.load(std::memory_order_acquire);
+  auto stats = std::vector<StageStat>(count);
+  auto sums  = std::vector<rep>(count, 0);
+  rep  top   = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    Histogram merged;
+    auto      add = [&](const ThreadData& data) {
+      auto acc = data.stages[i].load(std::memory_order_acquire);
+      if (!acc)
+        return;
+      if (drain) {
+        merged.drain(acc->hist);
+        sums[i] += acc->sum.exchange(0, std::memory_order_relaxed);
+      } else {
+        merged.merge(acc->hist);
+        sums[i] += acc->sum.load(std::memory_order_relaxed);
+      }
+    };
+    add(exited);
+    for (auto& data : threads)
+      add(*data);
+
+    auto& stat = stats[i];
+    stat.path  = path(i);
+    stat.count = merged.count();
+    stat.mean  = stat.count ? duration(sums[i] / rep(stat.count)) : duration(0);
+    stat.p50   = std::chrono::duration_cast<duration>(merged.percentile(50));
+    stat.p90   = std::chrono::duration_cast<duration>(merged.percentile(90));
+    stat.p99   = std::chrono::duration_cast<duration>(merged.percentile(99));
+    stat.max   = std::chrono::duration_cast<duration>(merged.max());
+    if (stages[i].parent.load(std::memory_order_relaxed) < 0)
+      top += sums[i];
+  }
+
+  auto budget = frame_budget.load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (budget > 0)
+      stats[i].share = double(stats[i].mean.count()) / double(budget);
+    else
+      stats[i].share = top > 0 ? double(sums[i]) / double(top) : 0;
+  }
+
+  std::sort(stats.begin(), stats.end(),
+            [](const StageStat& s0, const StageStat& s1) { return s0.path < s1.path; });
+  return stats;
+}
+
+}  // namespace cvs::logger::tools
+
+namespace cvs::logger::tools {
+
+StageTracker::Scope::Scope(StageTracker& t, std::size_t s)
+    : tracker(t)
+    , stage(s)
+    , parent(std::exchange(current_scope, this))
+    , start(clock::now()) {
+  if (parent && &parent->tracker == &tracker)
+    tracker.m->setParent(stage, parent->stage);
+}
+
+StageTracker::Scope::~Scope() {
+  current_scope = parent;
+  tracker.m->add(stage, clock::now() - start);
+}
+
+StageTracker::StageTracker(std::string_view name)
+    : m(std::make_shared<Private>())
+    , uid(m->uid) {
+  if (name.empty())
+    LOG_GLOB_CRITICAL("The StageTracker name must not be empty.");
+
+  m->logger   = cvs::logger::LoggerFactory::getLogger(name);
+  m->reporter = Reporter::instance();
+  m->reporter->add(m);
+  m->reporter->wake();
+}
+
+StageTracker::~StageTracker() { m->reporter->remove(m.get()); }
+
+std::size_t StageTracker::stage(std::string_view name) {
+  auto hash  = std::hash<std::string_view>{}(name);
+  auto count = m->stage_count.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (m->stages[i].hash == hash && m->stages[i].name == name)
+      return i;
+  }
+
+  std::lock_guard lock(m->mutex);
+  // Another thread may have registered the stage meanwhile.
+  count = m->stage_count.load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (m->stages[i].hash == hash && m->stages[i].name == name)
+      return i;
+  }
+  if (count == max_stages)
+    throw std::length_error("Can't add the stage " + std::string(name) + " to the tracker " +
+                            std::string(m->logger->name()));
+
+  m->stages[count].name = name;
+  m->stages[count].hash = hash;
+  m->stage_count.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+void StageTracker::record(std::size_t stage, duration d) { m->add(stage, d); }
+
+void StageTracker::setFrameBudget(duration d) {
+  m->frame_budget.store(d.count(), std::memory_order_relaxed);
+}
+duration StageTracker::frameBudget() const {
+  return duration(m->frame_budget.load(std::memory_order_relaxed));
+}
+
+void StageTracker::setReportDuration(duration d) {
+  m->report_period.store(d.count(), std::memory_order_relaxed);
+  m->reporter->wake();
+}
+duration StageTracker::reportDuration() const {
+  return duration(m->report_period.load(std::memory_order_relaxed));
+}
+
+void StageTracker::setAutoreport(bool enable) {
+  m->autolog.store(enable, std::memory_order_relaxed);
+  m->reporter->wake();
+}
+bool StageTracker::autoreport() const { return m->autolog.load(std::memory_order_relaxed); }
+
+std::vector<StageTracker::StageStat> StageTracker::getStat() const { return m->collect(false); }
+
+std::vector<StageTracker::StageStat> StageTracker::report() {
+  m->report_start.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+  return m->writeReport();
+}
+
+}  // namespace cvs::logger::tools
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <cvs/logger/config.hpp>
+#include <cvs/logger/logging.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <variant>
+
+using namespace cvs::logger;
+using namespace std::chrono_literals;
+
+TEST(ConfigTest, parse) {
+  auto config = Config::parse(R"(
+# Cameras
+[camera]
+level   = debug
+sinks   = stdout | file
+pattern = "[%n] %v"
+time    = utc
+file.max_size = 4M
+file.max_age  = 10min
+file.flush_interval = 200ms
+async.threads = 2
+dedup.timeout = 500ms
+
+[regex camera\..*]
+level = warn
+
+[]
+backend = deferred
+)");
+
+  auto& rules = config.rules();
+  ASSERT_EQ(rules.size(), 3u);
+
+  EXPECT_EQ(rules[0].name, "camera");
+  EXPECT_FALSE(rules[0].regex);
+  auto& options = rules[0].options;
+  ASSERT_EQ(options.size(), 6u);
+  EXPECT_EQ(std::get<Level>(options[0]), Level::debug);
+  EXPECT_EQ(std::get<Sinks>(options[1]), Sinks::STDOUT | Sinks::FILE);
+  EXPECT_EQ(std::get<Config::PatternOption>(options[2]),
+            (Config::PatternOption{"[%n] %v", TimeType::utc}));
+  EXPECT_EQ(std::get<LogFile>(options[3]).max_size, std::size_t(4) << 20);
+  EXPECT_EQ(std::get<LogFile>(options[3]).max_age, 10min);
+  EXPECT_EQ(std::get<LogFile>(options[3]).flush_interval, 200ms);
+  EXPECT_EQ(std::get<LogFile>(options[3]).buffer_size, LogFile{}.buffer_size);
+  EXPECT_EQ(std::get<Async>(options[4]).threads, 2u);
+  EXPECT_EQ(std::get<Dedup>(options[5]), (Dedup{true, 500ms}));
+
+  EXPECT_EQ(rules[1].name, "camera\\..*");
+  EXPECT_TRUE(rules[1].regex);
+  EXPECT_EQ(std::get<Level>(rules[1].options[0]), Level::warn);
+
+  EXPECT_EQ(rules[2].name, "");
+  EXPECT_EQ(std::get<Backend>(rules[2].options[0]), Backend::deferred);
+}
+
+TEST(ConfigTest, errors) {
+  EXPECT_THROW(Config::parse("level = info"), std::invalid_argument);
+  EXPECT_THROW(Config::parse("[a]\nlevel = loud"), std::invalid_argument);
+  EXPECT_THROW(Config::parse("[a]\nfile.max_size = 4X"), std::invalid_argument);
+  EXPECT_THROW(Config::parse("[a]\ncolor = red"), std::invalid_argument);
+  EXPECT_THROW(Config::parse("[a]\ntime = utc\n[b]\npattern = %v"), std::invalid_argument);
+  EXPECT_THROW(Config::load("/nonexistent/cvslogger.conf"), std::system_error);
+
+  try {
+    Config::parse("[a]\n\nlevel\n", "test.conf");
+    FAIL();
+  }
+  catch (const std::invalid_argument& e) {
+    EXPECT_EQ(std::string(e.what()).rfind("test.conf:3:", 0), 0u) << e.what();
+  }
+}
+
+TEST(ConfigTest, load) {
+  auto file = std::filesystem::temp_directory_path() / "cvslogger_config_test.conf";
+  std::ofstream(file) << "[test.config.load]\nlevel = err\nsinks = none\n";
+
+  LoggerFactory::configure(Config::load(file));
+  std::filesystem::remove(file);
+
+  EXPECT_EQ(LoggerFactory::getLogger("test.config.load")->level(), Level::err);
+}
+
+TEST(ConfigTest, incremental) {
+  auto logger0 = LoggerFactory::getLogger("test.config.a");
+  auto logger1 = LoggerFactory::getLogger("test.config.b");
+
+  LoggerFactory::configure(Config()
+                               .set(Regex{"test\\.config\\.[ab]"}, Level::info, Sinks::NOSINK)
+                               .set("test.config.b", Level::debug, Pattern{"%v"}));
+  EXPECT_EQ(logger0->level(), Level::info);
+  EXPECT_EQ(logger1->level(), Level::debug);
+
+  // Only the loggers matched by a changed rule are reconfigured.
+  spdlog::get("test.config.a")->set_level(spdlog::level::err);
+  EXPECT_FALSE(logger0->isEnabled(Level::warn));
+  LoggerFactory::configure(Config().set("test.config.b", Level::trace));
+  EXPECT_EQ(logger0->level(), Level::err);
+  EXPECT_FALSE(logger0->isEnabled(Level::warn));
+  EXPECT_EQ(logger1->level(), Level::trace);
+
+  // A batch that changes nothing leaves the loggers alone.
+  spdlog::get("test.config.b")->set_level(spdlog::level::err);
+  LoggerFactory::configure(Config().set("test.config.b", Level::trace));
+  EXPECT_EQ(logger1->level(), Level::err);
+
+  LoggerFactory::configure();
+  EXPECT_EQ(logger0->level(), Level::info);
+  EXPECT_EQ(logger1->level(), Level::trace);
+  EXPECT_TRUE(logger0->isEnabled(Level::warn));
+}
+
+TEST(ConfigTest, path) {
+  auto dir = std::filesystem::temp_directory_path() / "cvslogger_config_path";
+  LoggerFactory::configure(Config().set("test.config.path", dir, Sinks::NOSINK));
+  auto logger = LoggerFactory::getLogger("test.config.path");
+  EXPECT_EQ(logger->path(), dir);
+
+  // A later rule without a path keeps the path of the logger.
+  LoggerFactory::configure(Config().set(Regex{"test\\.config\\.path.*"}, Level::warn));
+  EXPECT_EQ(logger->level(), Level::warn);
+  EXPECT_EQ(logger->path(), dir);
+}
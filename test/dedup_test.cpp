@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <tuple>
+
+using namespace cvs::logger;
+
+TEST(DedupTest, collapse) {
+  LoggerFactory::configure("test.dedup", std::tuple{Level::trace, Sinks::STDOUT, Pattern{"%v"},
+                                                    Dedup{true, std::chrono::hours(1)}});
+  auto logger = LoggerFactory::getLogger("test.dedup");
+
+  testing::internal::CaptureStdout();
+  for (int i = 0; i < 5; ++i)
+    LOG_WARN(logger, "Test {}", 1);
+  LOG_ERROR(logger, "Test {}", 1);
+  LOG_ERROR(logger, "Test {}", 1);
+  LOG_ERROR(logger, "Test {}", 2);
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output,
+            "Test 1\nlast message repeated 4 times\nTest 1\nlast message repeated 1 times\n"
+            "Test 2\n");
+}
+
+TEST(DedupTest, timeout) {
+  LoggerFactory::configure("test.dedup.timeout",
+                           std::tuple{Level::trace, Sinks::STDOUT, Pattern{"%v"},
+                                      Dedup{true, std::chrono::milliseconds(20)}});
+  auto logger = LoggerFactory::getLogger("test.dedup.timeout");
+
+  testing::internal::CaptureStdout();
+  for (int i = 0; i < 3; ++i)
+    LOG_INFO(logger, "Test");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Test\nlast message repeated 2 times\n");
+}
+
+TEST(DedupTest, disable) {
+  LoggerFactory::configure("test.dedup.disable", std::tuple{Level::trace, Sinks::STDOUT,
+                                                            Pattern{"%v"}, Dedup{}});
+  auto logger = LoggerFactory::getLogger("test.dedup.disable");
+
+  testing::internal::CaptureStdout();
+  LOG_INFO(logger, "Test");
+  LOG_INFO(logger, "Test");
+  LoggerFactory::configure("test.dedup.disable", std::tuple{Dedup{false}});
+  LOG_INFO(logger, "Test");
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Test\nlast message repeated 1 times\nTest\n");
+}
@@ -0,0 +1,96 @@
+#include "../src/deferredbackend.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace cvs::logger;
+
+TEST(DeferredTest, sinks) {
+  LoggerFactory::configure("test.deferred", std::tuple{Level::trace, Sinks::STDOUT,
+                                                       Pattern{"%v"}, Backend::deferred});
+  auto logger = LoggerFactory::getLogger("test.deferred");
+
+  std::string text = "string";
+  testing::internal::CaptureStdout();
+  LOG_INFO(logger, "Test {} {} {} {}", 1, 2.5, text, "literal");
+  LOG_DEBUG(logger, "Test {:>4}", 'c');
+  deferred::flush();
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Test 1 2.5 string literal\nTest    c\n");
+}
+
+TEST(DeferredTest, runtime_format) {
+  LoggerFactory::configure("test.deferred.runtime", std::tuple{Level::trace, Sinks::STDOUT,
+                                                               Pattern{"%v"}, Backend::deferred});
+  auto logger = LoggerFactory::getLogger("test.deferred.runtime");
+
+  // Runtime formats are formatted before the call returns, their text may be gone at the flush.
+  std::string format = "Runtime format {}";
+  testing::internal::CaptureStdout();
+  LOG_INFO(logger, fmt::runtime(format), 1);
+  LOG_INFO(logger, fmt::runtime(std::string("Temporary runtime format {}")), 2);
+  format = "Overwritten format {}";
+  deferred::flush();
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Runtime format 1\nTemporary runtime format 2\n");
+}
+
+TEST(DeferredTest, threads) {
+  LoggerFactory::configure("test.deferred.threads", std::tuple{Level::trace, Sinks::NOSINK,
+                                                               Backend::deferred});
+  auto logger = LoggerFactory::getLogger("test.deferred.threads");
+
+  auto                     dropped = deferred::dropped();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&logger] {
+      for (int i = 0; i < 1000; ++i)
+        LOG_TRACE(logger, "Test {}", i);
+    });
+  for (auto& t : threads)
+    t.join();
+  deferred::flush();
+
+  EXPECT_EQ(dropped, deferred::dropped());
+}
+
+TEST(DeferredTest, binary) {
+  auto dir = std::filesystem::temp_directory_path() / "cvslogger_deferred_test";
+  std::filesystem::remove_all(dir);
+
+  LoggerFactory::configure("test.deferred.binary", std::tuple{Level::trace, dir, Backend::binary});
+  auto logger = LoggerFactory::getLogger("test.deferred.binary");
+
+  LOG_INFO(logger, "Test {} {}", 1, "binary");
+  LOG_INFO(logger, "Test {} {}", 2, "binary");
+  deferred::flush();
+
+  auto file = DeferredBackend::logFile(dir);
+  ASSERT_TRUE(std::filesystem::exists(file));
+
+  // Decoded the way cvslogger_decode does.
+  std::ifstream in(file, std::ios::binary);
+  std::string   log(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>{});
+
+  std::vector<DeferredBackend::Message> messages;
+  DeferredBackend::decode(log, [&](const DeferredBackend::Message& m) { messages.push_back(m); });
+
+  ASSERT_EQ(messages.size(), 2u);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(messages[i].logger, "test.deferred.binary");
+    EXPECT_EQ(messages[i].level, Level::info);
+    EXPECT_EQ(messages[i].text, "Test " + std::to_string(i + 1) + " binary");
+  }
+  EXPECT_LE(messages[0].timestamp, messages[1].timestamp);
+}
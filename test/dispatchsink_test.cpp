@@ -0,0 +1,191 @@
+#include "../src/default/dispatchsink.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cvs/logger/ilogger.hpp>
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cvs::logger;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Keeps the payloads and the images passed with them.
+class TestSink : public spdlog::sinks::base_sink<std::mutex> {
+ public:
+  std::vector<std::string>              payloads;
+  std::vector<std::vector<std::string>> images;
+
+  // Messages written so far, while other threads may write.
+  std::size_t count() {
+    std::lock_guard lock(mutex_);
+    return payloads.size();
+  }
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg& msg) override {
+    payloads.emplace_back(msg.payload.data(), msg.payload.size());
+    images.push_back(ILogger::messageImages());
+  }
+  void flush_() override {}
+};
+
+// Blocks every message until the test opens the gate.
+class GateSink : public TestSink {
+ public:
+  void waitBlocked(std::size_t count) {
+    std::unique_lock lock(gate_mutex);
+    cv.wait(lock, [&]() { return blocked >= count; });
+  }
+
+  void open() {
+    {
+      std::lock_guard lock(gate_mutex);
+      opened = true;
+    }
+    cv.notify_all();
+  }
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg& msg) override {
+    {
+      std::unique_lock lock(gate_mutex);
+      ++blocked;
+      cv.notify_all();
+      cv.wait(lock, [this]() { return opened; });
+    }
+    TestSink::sink_it_(msg);
+  }
+
+ private:
+  std::mutex              gate_mutex;
+  std::condition_variable cv;
+  std::size_t             blocked = 0;
+  bool                    opened  = false;
+};
+
+spdlog::details::log_msg message(std::string_view text) {
+  return {"test.dispatch", spdlog::level::info, text};
+}
+
+}  // namespace
+
+TEST(DispatchSinkTest, images) {
+  auto         sink = std::make_shared<TestSink>();
+  DispatchSink dispatch({sink}, std::make_shared<StatCounters>());
+
+  ILogger::messageImages() = {"/tmp/0.png"};
+  dispatch.log(message("Sync"));
+  EXPECT_TRUE(ILogger::messageImages().empty());
+
+  // The worker thread gets the images queued with the message.
+  dispatch.setAsync(Async{4, Overflow::block, 1});
+  ILogger::messageImages() = {"/tmp/1.png", "/tmp/2.png"};
+  dispatch.log(message("Async"));
+  dispatch.log(message("None"));
+  dispatch.flush();
+
+  using Images = std::vector<std::string>;
+  EXPECT_EQ(sink->payloads, (std::vector<std::string>{"Sync", "Async", "None"}));
+  EXPECT_EQ(sink->images,
+            (std::vector<Images>{{"/tmp/0.png"}, {"/tmp/1.png", "/tmp/2.png"}, {}}));
+}
+
+TEST(DispatchSinkTest, overflow) {
+  for (auto overflow : {Overflow::drop_newest, Overflow::drop_oldest}) {
+    auto         gate = std::make_shared<GateSink>();
+    DispatchSink dispatch({gate}, std::make_shared<StatCounters>());
+    dispatch.setAsync(Async{4, overflow, 1});
+
+    // The worker blocks in the sink with message 0 while 1 to 10 overflow the queue of 4.
+    dispatch.log(message("0"));
+    gate->waitBlocked(1);
+    for (int i = 1; i <= 10; ++i)
+      dispatch.log(message(std::to_string(i)));
+    EXPECT_EQ(dispatch.dropped(), 6u);
+
+    gate->open();
+    dispatch.flush();
+    if (overflow == Overflow::drop_newest)
+      EXPECT_EQ(gate->payloads, (std::vector<std::string>{"0", "1", "2", "3", "4"}));
+    else
+      EXPECT_EQ(gate->payloads, (std::vector<std::string>{"0", "7", "8", "9", "10"}));
+    EXPECT_EQ(dispatch.dropped(), 6u);
+  }
+}
+
+TEST(DispatchSinkTest, blockedRepeats) {
+  auto         gate = std::make_shared<GateSink>();
+  DispatchSink blocked({gate}, std::make_shared<StatCounters>());
+  blocked.setDedup(Dedup{true, 1ms});
+
+  // The first message blocks in the sink, its repeat count falls due meanwhile.
+  std::thread writer([&]() { blocked.log(message("Blocked")); });
+  gate->waitBlocked(1);
+  blocked.log(message("Blocked"));
+
+  // The repeats of another sink are still written on time.
+  auto         sink = std::make_shared<TestSink>();
+  DispatchSink other({sink}, std::make_shared<StatCounters>());
+  other.setDedup(Dedup{true, 1ms});
+  other.log(message("Other"));
+  other.log(message("Other"));
+
+  auto deadline = std::chrono::steady_clock::now() + 10s;
+  while (sink->count() < 2 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(1ms);
+  EXPECT_EQ(sink->payloads,
+            (std::vector<std::string>{"Other", "last message repeated 1 times"}));
+
+  // The count handed to the blocked thread follows its message.
+  gate->open();
+  writer.join();
+  blocked.flush();
+  EXPECT_EQ(gate->payloads,
+            (std::vector<std::string>{"Blocked", "last message repeated 1 times"}));
+}
+
+TEST(DispatchSinkTest, emittedAfterDedup) {
+  auto         sink     = std::make_shared<TestSink>();
+  auto         counters = std::make_shared<StatCounters>();
+  DispatchSink dispatch({sink}, counters);
+  dispatch.setDedup(Dedup{true, 1h});
+
+  for (int i = 0; i < 10; ++i)
+    dispatch.log(message("Same"));
+  dispatch.flush();
+
+  // The first message and its repeat count reach the sink, the repeats are not counted.
+  ASSERT_EQ(sink->payloads.size(), 2u);
+  auto stats = counters->load();
+  EXPECT_EQ(stats.emitted, 2u);
+  EXPECT_EQ(stats.bytes, sink->payloads[0].size() + sink->payloads[1].size());
+}
+
+TEST(DispatchSinkTest, emittedAsync) {
+  auto         gate     = std::make_shared<GateSink>();
+  auto         counters = std::make_shared<StatCounters>();
+  DispatchSink dispatch({gate}, counters);
+  dispatch.setAsync(Async{1, Overflow::drop_newest, 1});
+
+  dispatch.log(message("Written"));
+  gate->waitBlocked(1);
+  dispatch.log(message("Queued"));
+  dispatch.log(message("Dropped"));
+  gate->open();
+  dispatch.flush();
+
+  // Dropped messages never reach the sinks.
+  EXPECT_EQ(dispatch.dropped(), 1u);
+  EXPECT_EQ(counters->load().emitted, 2u);
+}
@@ -1,10 +1,12 @@
 #include <gtest/gtest.h>
 
-#include <cvs/logger/logging.h>
+#include <cvs/logger/logging.hpp>
 
 #include <list>
 #include <regex>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 using namespace cvs::logger;
 
@@ -69,3 +71,98 @@ TEST(DefraultFactoryTest, regex) {
   LOG_WARN(logger1, "test");
   LOG_ERROR(logger1, "test");
 }
+
+TEST(DefraultFactoryTest, cached_logger) {
+  CachedLogger cached("test.cached");
+  EXPECT_EQ(cached.get(), LoggerFactory::getLogger("test.cached").get());
+
+  auto factory = LoggerFactory::instance();
+  auto before  = LoggerFactory::cacheGeneration();
+  LoggerFactory::registerCreator([factory]() { return factory; });
+  EXPECT_NE(before, LoggerFactory::cacheGeneration());
+  EXPECT_EQ(cached.get(), LoggerFactory::getLogger("test.cached").get());
+
+  LoggerFactory::configure("test.cached", std::tuple{Level::trace, Sinks::STDOUT});
+  for (int i = 0; i < 3; ++i) {
+    LOG_NAMED_TRACE("test.cached", "Test {}", i);
+    LOG_GLOB_INFO("Test {}", i);
+  }
+}
+
+TEST(DefraultFactoryTest, async) {
+  // The drop counts of the overflow modes are checked with a blocking sink in DispatchSinkTest.
+  LoggerFactory::configure(
+      "test.async", std::tuple{Level::trace, Sinks::NOSINK, Async{8, Overflow::block, 2}});
+
+  auto logger  = LoggerFactory::getLogger("test.async");
+  auto emitted = LoggerFactory::stats().loggers["test.async"].emitted;
+  for (int i = 0; i < 100; ++i)
+    LOG_TRACE(logger, "Test {}", i);
+
+  // The old workers write out their queues when the logger becomes synchronous.
+  LoggerFactory::configure("test.async", std::tuple{Async{0, Overflow::block, 0}});
+  LOG_INFO(logger, "Test sync");
+  EXPECT_EQ(logger->dropped(), 0u);
+  EXPECT_EQ(LoggerFactory::stats().loggers["test.async"].emitted, emitted + 101);
+}
+
+TEST(DefraultFactoryTest, rule_order) {
+  LoggerFactory::configure("test.match.a", std::tuple{Level::trace});
+  LoggerFactory::configure(Regex{"test\\.match\\..*"}, std::tuple{Level::err});
+  LoggerFactory::configure(Regex{"test\\.match\\.[bc]"}, std::tuple{Level::warn});
+
+  // Rules are applied in the lexicographic order of their patterns.
+  EXPECT_EQ(LoggerFactory::getLogger("test.match.a")->level(), Level::trace);
+  EXPECT_EQ(LoggerFactory::getLogger("test.match.b")->level(), Level::warn);
+  EXPECT_EQ(LoggerFactory::getLogger("test.match.d")->level(), Level::err);
+  EXPECT_EQ(LoggerFactory::getLogger("test.matchx")->level(), Level::info);
+
+  LoggerFactory::configure(Regex{"test\\.match\\..*"}, std::tuple{Level::debug});
+  LoggerFactory::configure();
+  EXPECT_EQ(LoggerFactory::getLogger("test.match.d")->level(), Level::debug);
+}
+
+TEST(DefraultFactoryTest, concurrent_creation) {
+  constexpr int thread_count = 8;
+  constexpr int logger_count = 64;
+
+  std::vector<std::vector<LoggerPtr>> created(thread_count);
+  std::vector<std::thread>            threads;
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([t, &created]() {
+      for (int i = 0; i < logger_count; ++i)
+        created[t].push_back(LoggerFactory::getLogger("test.concurrent." + std::to_string(i)));
+    });
+  }
+  for (auto& t : threads)
+    t.join();
+
+  for (int t = 1; t < thread_count; ++t)
+    EXPECT_EQ(created[0], created[t]);
+}
+
+TEST(DefraultFactoryTest, stats) {
+  LoggerFactory::configure("test.stats", std::tuple{Level::info, Sinks::NOSINK});
+  auto logger = LoggerFactory::getLogger("test.stats");
+
+  // More threads than counter shards, each counts its filtered calls in its own slot.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 16; ++t)
+    threads.emplace_back([&logger] {
+      for (int i = 0; i < 100; ++i) {
+        LOG_DEBUG(logger, "Test {}", i);
+        LOG_INFO(logger, "Test");
+      }
+    });
+  for (auto& t : threads)
+    t.join();
+
+  auto stats = LoggerFactory::stats();
+  auto it    = stats.loggers.find("test.stats");
+  ASSERT_NE(it, stats.loggers.end());
+  EXPECT_EQ(it->second.emitted, 1600u);
+  EXPECT_EQ(it->second.filtered, 1600u);
+  EXPECT_EQ(it->second.bytes, 6400u);
+  EXPECT_EQ(it->second.dropped, 0u);
+  EXPECT_GE(stats.total.emitted, it->second.emitted);
+}
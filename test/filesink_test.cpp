@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+
+#ifdef CVSLOGGER_ZLIB_ENABLED
+#include <zlib.h>
+#endif
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+
+using namespace cvs::logger;
+
+namespace {
+
+std::filesystem::path cleanDir(const std::string& name) {
+  auto dir = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(dir);
+  return dir;
+}
+
+std::string readFile(const std::filesystem::path& file) {
+  std::ifstream      in(file);
+  std::ostringstream out;
+  out << in.rdbuf();
+  return out.str();
+}
+
+std::size_t countFiles(const std::filesystem::path& dir) {
+  std::size_t count = 0;
+  for ([[maybe_unused]] auto& entry : std::filesystem::directory_iterator(dir))
+    ++count;
+  return count;
+}
+
+}  // namespace
+
+TEST(FileSinkTest, buffered) {
+  auto dir = cleanDir("cvslogger_file_test");
+  LoggerFactory::configure("test.file", std::tuple{Level::trace, Sinks::FILE, Pattern{"%v"}, dir,
+                                                   LogFile{0, {}, 4096, Level::err, false}});
+  auto logger = LoggerFactory::getLogger("test.file");
+
+  LOG_INFO(logger, "Test {}", 0);
+  EXPECT_EQ(readFile(dir / "test.file.log"), "");
+
+  LOG_ERROR(logger, "Test {}", 1);
+  EXPECT_EQ(readFile(dir / "test.file.log"), "Test 0\nTest 1\n");
+}
+
+TEST(FileSinkTest, flush_interval) {
+  using namespace std::chrono_literals;
+
+  auto    dir = cleanDir("cvslogger_file_interval_test");
+  LogFile options{0, {}, 4096, Level::err, false};
+  options.flush_interval = 20ms;
+  LoggerFactory::configure("test.file.interval",
+                           std::tuple{Level::trace, Sinks::FILE, Pattern{"%v"}, dir, options});
+  auto logger = LoggerFactory::getLogger("test.file.interval");
+
+  // The buffer is written by the timer without further messages or a flush.
+  LOG_INFO(logger, "Test {}", 0);
+  auto deadline = std::chrono::steady_clock::now() + 10s;
+  while (readFile(dir / "test.file.interval.log").empty() &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(1ms);
+  EXPECT_EQ(readFile(dir / "test.file.interval.log"), "Test 0\n");
+}
+
+TEST(FileSinkTest, rotation) {
+  auto dir = cleanDir("cvslogger_rotation_test");
+  LoggerFactory::configure("test.file.rotation",
+                           std::tuple{Level::trace, Sinks::FILE, Pattern{"%v"}, dir,
+                                      LogFile{100, {}, 4096, Level::trace, false}});
+  auto logger = LoggerFactory::getLogger("test.file.rotation");
+
+  // 10 bytes per message, so every segment holds 10 messages.
+  for (int i = 0; i < 95; ++i)
+    LOG_INFO(logger, "Test {:04}", i);
+
+  EXPECT_EQ(countFiles(dir), 10u);
+  EXPECT_EQ(readFile(dir / "test.file.rotation.log").size(), 50u);
+}
+
+TEST(FileSinkTest, mmap) {
+  auto dir = cleanDir("cvslogger_mmap_test");
+  LoggerFactory::configure("test.file.mmap",
+                           std::tuple{Level::trace, Sinks::FILE, Pattern{"%v"}, dir,
+                                      LogFile{0, {}, 4096, Level::err, true}});
+  auto logger = LoggerFactory::getLogger("test.file.mmap");
+
+  std::string expected;
+  for (int i = 0; i < 1000; ++i) {
+    LOG_INFO(logger, "Test {:04}", i);
+    expected += fmt::format("Test {:04}\n", i);
+  }
+  // The mapped data is visible before the file is closed.
+  EXPECT_EQ(readFile(dir / "test.file.mmap.log").substr(0, expected.size()), expected);
+
+  // Switching the mode closes the segment and cuts the preallocated tail.
+  LoggerFactory::configure("test.file.mmap", std::tuple{LogFile{}});
+  LoggerFactory::configure();
+  EXPECT_EQ(readFile(dir / "test.file.mmap.log"), expected);
+}
+
+TEST(FileSinkTest, retention) {
+  auto dir = cleanDir("cvslogger_retention_test");
+  LoggerFactory::configure("test.file.retention",
+                           std::tuple{Level::trace, Sinks::FILE, Pattern{"%v"}, dir,
+                                      LogFile{100, {}, 4096, Level::trace, false, false, 300}});
+  auto logger = LoggerFactory::getLogger("test.file.retention");
+
+  for (int i = 0; i < 95; ++i)
+    LOG_INFO(logger, "Test {:04}", i);
+
+  // The active segment and the 3 newest rotated ones.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (countFiles(dir) > 4 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(countFiles(dir), 4u);
+}
+
+#ifdef CVSLOGGER_ZLIB_ENABLED
+TEST(FileSinkTest, compression) {
+  auto dir = cleanDir("cvslogger_compression_test");
+  LoggerFactory::configure("test.file.compression",
+                           std::tuple{Level::trace, Sinks::FILE, Pattern{"%v"}, dir,
+                                      LogFile{100, {}, 4096, Level::trace, false, true, 0}});
+  auto logger = LoggerFactory::getLogger("test.file.compression");
+
+  for (int i = 0; i < 20; ++i)
+    LOG_INFO(logger, "Test {:04}", i);
+
+  auto first = [&] {
+    for (auto& entry : std::filesystem::directory_iterator(dir))
+      if (entry.path().extension() == ".gz")
+        return entry.path();
+    return std::filesystem::path();
+  };
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (first().empty() && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  auto archive = first();
+  ASSERT_FALSE(archive.empty());
+
+  gzFile in = gzopen(archive.c_str(), "rb");
+  ASSERT_NE(in, nullptr);
+  char buffer[256];
+  int  size = gzread(in, buffer, sizeof(buffer));
+  gzclose(in);
+  EXPECT_EQ(std::string(buffer, std::max(size, 0)).substr(0, 10), "Test 0000\n");
+}
+#endif
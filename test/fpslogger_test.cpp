@@ -0,0 +1,212 @@
+#include "../src/tools/reporter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+#include <cvs/logger/tools/fpslogger.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace cvs::logger;
+using namespace std::chrono_literals;
+
+TEST(FpsLoggerTest, frames) {
+  LoggerFactory::configure("test.fps", std::tuple{Level::info, Sinks::NOSINK});
+  tools::FpsLogger fps_logger("test.fps");
+  fps_logger.start();
+
+  auto t = tools::FpsLogger::clock::now();
+  for (int i = 0; i < 11; ++i)
+    fps_logger.newFrame(t + i * 10ms);
+
+  auto stat = fps_logger.getStat();
+  EXPECT_EQ(stat.total_cnt, 11u);
+  EXPECT_DOUBLE_EQ(stat.fps, 100.);
+  EXPECT_DOUBLE_EQ(stat.last_fps, 100.);
+  EXPECT_EQ(stat.max, 10ms);
+  EXPECT_GE(stat.p50, 10ms);
+  EXPECT_LE(stat.p99, 10ms);
+}
+
+TEST(FpsLoggerTest, concurrent) {
+  LoggerFactory::configure("test.fps.threads", std::tuple{Level::trace, Sinks::NOSINK});
+  tools::FpsLogger fps_logger("test.fps.threads");
+  fps_logger.setReportDuration(1ms);
+  fps_logger.start();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&fps_logger] {
+      for (int i = 0; i < 1000; ++i)
+        fps_logger.newFrame();
+    });
+  for (auto& t : threads)
+    t.join();
+
+  auto stat = fps_logger.getStat();
+  EXPECT_EQ(stat.total_cnt, 4000u);
+  EXPECT_GT(stat.fps, 0.);
+  fps_logger.stop();
+}
+
+TEST(FpsLoggerTest, histogram) {
+  tools::Histogram hist;
+  for (int i = 1; i <= 1000; ++i)
+    hist.record(std::chrono::microseconds(i));
+
+  EXPECT_EQ(hist.count(), 1000u);
+  EXPECT_EQ(hist.max(), 1000us);
+  for (double p : {50., 90., 99., 99.9}) {
+    auto expected = std::chrono::duration<double, std::micro>(p * 10);
+    auto value    = std::chrono::duration<double, std::micro>(hist.percentile(p));
+    EXPECT_GE(value, expected);
+    EXPECT_LE(value, expected * 1.04);
+  }
+  EXPECT_EQ(hist.percentile(100), 1000us);
+
+  tools::Histogram merged;
+  merged.merge(hist);
+  merged.record(1s);
+  EXPECT_EQ(merged.count(), 1001u);
+  EXPECT_EQ(merged.max(), 1s);
+
+  tools::Histogram drained;
+  drained.drain(merged);
+  EXPECT_EQ(drained.count(), 1001u);
+  EXPECT_EQ(merged.count(), 0u);
+}
+
+TEST(FpsLoggerTest, reporter) {
+  LoggerFactory::configure("test.fps.report", std::tuple{Level::debug, Sinks::STDOUT,
+                                                         Pattern{"%n: %v"}},
+                           "test.fps.combined", std::tuple{Level::debug, Sinks::STDOUT,
+                                                           Pattern{"%n: %v"}});
+  tools::FpsLogger camera0("test.fps.report");
+  tools::FpsLogger camera1("test.fps.report");
+  tools::FpsLogger camera2("test.fps.report");
+  camera0.setReportDuration(1h);
+  camera1.setAutoreport(false);
+  camera2.setReportDuration(0s);
+
+  testing::internal::CaptureStdout();
+  tools::FpsLogger::setCombinedReport(1h, "test.fps.combined");
+  camera0.start();
+  camera1.start();
+  camera2.start();
+  auto t = tools::FpsLogger::clock::now();
+  for (int i = 0; i < 10; ++i) {
+    camera0.newFrame(t + i * 10ms);
+    camera1.newFrame(t + i * 10ms);
+    camera2.newFrame(t + i * 10ms);
+  }
+  tools::FpsLogger::flushReports();
+  tools::FpsLogger::setCombinedReport(0ms);
+  camera0.setAutoreport(false);
+  camera2.setAutoreport(false);
+  auto output = testing::internal::GetCapturedStdout();
+
+  // Only camera0 has periodic reports, camera2 disabled them with the zero period.
+  auto report = output.find("test.fps.report: FPS for last 10 frames");
+  EXPECT_NE(report, std::string::npos) << output;
+  EXPECT_EQ(output.find("test.fps.report: FPS", report + 1), std::string::npos) << output;
+  EXPECT_NE(output.find("test.fps.combined: 3 FPS loggers, 30 frames"), std::string::npos)
+      << output;
+}
+
+namespace {
+
+// Report that runs until the test releases it.
+class BlockingSource : public tools::Reporter::Source {
+ public:
+  void waitEntered() {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [this]() { return entered; });
+  }
+
+  void release() {
+    {
+      std::lock_guard lock(mutex);
+      released = true;
+    }
+    cv.notify_all();
+  }
+
+  tools::Reporter::time_point report(tools::Reporter::time_point, bool) override {
+    std::unique_lock lock(mutex);
+    entered = true;
+    cv.notify_all();
+    cv.wait(lock, [this]() { return released; });
+    return tools::Reporter::time_point::max();
+  }
+
+ private:
+  std::mutex              mutex;
+  std::condition_variable cv;
+  bool                    entered  = false;
+  bool                    released = false;
+};
+
+}  // namespace
+
+TEST(FpsLoggerTest, reporter_unlocked) {
+  auto reporter = tools::Reporter::instance();
+  auto blocking = std::make_shared<BlockingSource>();
+  reporter->add(blocking);
+  reporter->wake();
+  blocking->waitEntered();
+
+  // Sources are added while a report runs, removing the running one waits for it.
+  auto other = std::make_shared<BlockingSource>();
+  other->release();
+  reporter->add(other);
+
+  std::atomic_bool removed{false};
+  std::thread      remover([&]() {
+    reporter->remove(blocking.get());
+    removed = true;
+  });
+  std::this_thread::sleep_for(10ms);
+  EXPECT_FALSE(removed);
+
+  blocking->release();
+  remover.join();
+  EXPECT_TRUE(removed);
+  reporter->remove(other.get());
+}
+
+TEST(FpsLoggerTest, window) {
+  LoggerFactory::configure("test.fps.window", std::tuple{Level::info, Sinks::NOSINK});
+  tools::FpsLogger fps_logger("test.fps.window");
+  fps_logger.setWindow(1s);
+  EXPECT_EQ(fps_logger.window(), 1s);
+  fps_logger.start();
+
+  // 100 FPS for a second, a two seconds stall and 100 FPS for the last second again.
+  auto t = tools::FpsLogger::clock::now() - 4s;
+  for (int i = 0; i < 100; ++i)
+    fps_logger.newFrame(t + i * 10ms);
+  EXPECT_DOUBLE_EQ(fps_logger.windowFps(), 0.);
+
+  t += 3s;
+  for (int i = 0; i <= 100; ++i)
+    fps_logger.newFrame(t + i * 10ms);
+  auto stat = fps_logger.getStat();
+  EXPECT_NEAR(stat.window_fps, 100., 3.);
+  EXPECT_LT(stat.fps, 60.);
+
+  fps_logger.clear();
+  EXPECT_DOUBLE_EQ(fps_logger.windowFps(), 0.);
+
+  // A late frame maps to the bucket of the newer frames, but must not reset it.
+  auto now = tools::FpsLogger::clock::now();
+  for (int i = 0; i < 100; ++i)
+    fps_logger.newFrame(now);
+  fps_logger.newFrame(now - 2s);
+  EXPECT_GT(fps_logger.windowFps(), 0.);
+}
@@ -0,0 +1,67 @@
+#include "../src/framering.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <tuple>
+#include <vector>
+
+using namespace cvs::logger;
+
+namespace {
+
+std::filesystem::path ringFile(const char* name) {
+  auto file = std::filesystem::temp_directory_path() / "images" / name;
+  std::filesystem::remove(file);
+  return file;
+}
+
+}  // namespace
+
+TEST(FrameRingTest, lapping) {
+  FrameRing ring(ringFile("test.lapping.ring"), 4096);
+
+  // A slow writer holds half of the ring.
+  auto slow = ring.reserve(2048);
+  ASSERT_NE(slow.record, nullptr);
+  auto pixels = reinterpret_cast<unsigned char*>(slow.record + 1);
+  std::memset(pixels, 0x5a, 2048 - sizeof(FrameRing::FrameRecord));
+
+  // Fast writers fill the other half and are dropped instead of wrapping over the slow one.
+  std::vector<unsigned char> frame(512 - sizeof(FrameRing::FrameRecord), 0xff);
+  for (int i = 0; i < 4; ++i)
+    EXPECT_GE(ring.write(1, 1, int(frame.size()), 0, frame.size(), frame.data(), frame.size()), 0);
+  EXPECT_EQ(ring.write(1, 1, int(frame.size()), 0, frame.size(), frame.data(), frame.size()), -1);
+
+  ring.commit(slow);
+  EXPECT_EQ(slow.record->magic, FrameRing::record_magic);
+  EXPECT_EQ(slow.record->size, 2048u);
+  EXPECT_TRUE(std::all_of(pixels, pixels + 2048 - sizeof(FrameRing::FrameRecord),
+                          [](unsigned char p) { return p == 0x5a; }));
+
+  // The committed record can be overwritten.
+  EXPECT_EQ(ring.write(1, 1, int(frame.size()), 0, frame.size(), frame.data(), frame.size()),
+            std::int64_t(FrameRing::data_offset));
+}
+
+TEST(FrameRingTest, replaced) {
+  LoggerFactory::configure("test.replaced.ring", std::tuple{Sinks::NOSINK, ImageRing{4096}});
+  auto logger = LoggerFactory::getLogger("test.replaced.ring");
+
+  auto ring = logger->frameRing();
+  ASSERT_NE(ring, nullptr);
+
+  // A writer that loaded the ring before it was replaced keeps it mapped.
+  LoggerFactory::configure("test.replaced.ring", std::tuple{ImageRing{8192}});
+  auto next = logger->frameRing();
+  ASSERT_NE(next, nullptr);
+  EXPECT_NE(ring, next);
+  EXPECT_EQ(next->capacity(), 8192u);
+
+  std::vector<unsigned char> frame(64, 1);
+  EXPECT_GE(ring->write(1, 1, int(frame.size()), 0, frame.size(), frame.data(), frame.size()), 0);
+}
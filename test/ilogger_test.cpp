@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <tuple>
+
+using namespace cvs::logger;
+
+namespace {
+
+struct CopyCounter {
+  CopyCounter() = default;
+  CopyCounter(const CopyCounter&) { ++copies; }
+  CopyCounter(CopyCounter&&) noexcept { ++copies; }
+
+  static inline int copies = 0;
+};
+
+}  // namespace
+
+template <>
+struct fmt::formatter<CopyCounter> : fmt::formatter<std::string_view> {
+  template <typename FormatContext>
+  auto format(const CopyCounter&, FormatContext& ctx) const {
+    return fmt::formatter<std::string_view>::format("CopyCounter", ctx);
+  }
+};
+
+namespace {
+
+TEST(ILoggerTest, no_argument_copies) {
+  LoggerFactory::configure("test.copies", std::tuple{Level::trace, Sinks::NOSINK});
+  auto logger = LoggerFactory::getLogger("test.copies");
+
+  CopyCounter       counter;
+  const CopyCounter const_counter;
+  LOG_TRACE(logger, "{} {}", counter, const_counter);
+  LOG_INFO(logger, "{} {} {}", counter, std::string("string"), 42);
+
+  EXPECT_EQ(CopyCounter::copies, 0);
+}
+
+}  // namespace
+
+namespace {
+
+TEST(ILoggerTest, format_strings) {
+  LoggerFactory::configure("test.format", std::tuple{Level::trace, Sinks::STDOUT});
+  auto logger = LoggerFactory::getLogger("test.format");
+
+  LOG_INFO(logger, "Literal {} {:.2f}", 1, 2.0);
+  LOG_INFO(logger, FMT_COMPILE("Compiled {} {:.2f}"), 1, 2.0);
+
+  std::string runtime = "Runtime {} {:.2f}";
+  LOG_INFO(logger, runtime, 1, 2.0);
+  LOG_INFO(logger, std::string_view(runtime), 1, 2.0);
+  LOG_INFO(logger, fmt::runtime(runtime), 1, 2.0);
+
+  CopyCounter::copies = 0;
+  CopyCounter counter;
+  LOG_INFO(logger, FMT_COMPILE("{}"), counter);
+  LOG_INFO(logger, runtime.substr(0, 10), counter);
+  EXPECT_EQ(CopyCounter::copies, 0);
+}
+
+}  // namespace
@@ -1,11 +1,17 @@
+#include "../src/framering.hpp"
+
 #include <gtest/gtest.h>
 
-#include <cvs/logger/logging.h>
+#include <cvs/logger/logging.hpp>
 
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <fstream>
+#include <iterator>
+#include <vector>
+
 using namespace cvs::logger;
 
 namespace {
@@ -33,8 +39,67 @@ TEST(CVSLoggerTest, opencv) {
 
   auto logger = LoggerFactory::getLogger("test.logger");
   LOG_INFO(logger, "Save to {}", mat);
+  flushImages();
 
   ASSERT_TRUE(std::filesystem::exists("/tmp/images/test.logger/2/0.png"));
 }
 
+TEST(CVSLoggerTest, opencv_raw) {
+  cv::Mat mat(300, 300, CV_8UC3, cv::Scalar(0));
+  drawRandomLines(mat);
+  cv::Mat roi(mat, cv::Rect(10, 10, 100, 100));
+
+  // A ring left by a previous run would be continued.
+  std::filesystem::remove("/tmp/images/test.raw.ring");
+  LoggerFactory::configure("test.raw",
+                           std::tuple{LogImage::raw, ImageRing{1 << 20}, Sinks::STDOUT});
+
+  auto logger = LoggerFactory::getLogger("test.raw");
+  LOG_INFO(logger, "Save to {}", mat);
+  LOG_INFO(logger, "Save to {}", roi);
+
+  ASSERT_TRUE(std::filesystem::exists("/tmp/images/test.raw.ring"));
+  ASSERT_EQ(std::filesystem::file_size("/tmp/images/test.raw.ring"), 4096 + (1 << 20));
+
+  // Decode the frames back the way cvslogger_ringextract does.
+  std::ifstream     file("/tmp/images/test.raw.ring", std::ios::binary);
+  std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  auto pos = FrameRing::data_offset;
+  for (auto& expected : {mat, roi}) {
+    auto record = reinterpret_cast<const FrameRing::FrameRecord*>(data.data() + pos);
+    ASSERT_EQ(record->magic, FrameRing::record_magic);
+    EXPECT_EQ(record->level, std::uint32_t(Level::info));
+
+    cv::Mat frame(record->rows, record->cols, record->type,
+                  const_cast<FrameRing::FrameRecord*>(record + 1), record->step);
+    ASSERT_EQ(frame.size(), expected.size());
+    ASSERT_EQ(frame.type(), expected.type());
+    EXPECT_EQ(cv::norm(frame, expected, cv::NORM_INF), 0.);
+    pos += record->size;
+  }
+}
+
+
+TEST(CVSLoggerTest, opencv_recorder) {
+  cv::Mat mat(300, 300, CV_8UC3, cv::Scalar(0));
+  drawRandomLines(mat);
+
+  std::filesystem::remove_all("/tmp/images/test.recorder.image");
+  LoggerFactory::configure("test.recorder.image", std::tuple{Level::info, LogImage::enable,
+                                                             Sinks::STDOUT, Pattern{"%v"},
+                                                             Recorder{}});
+
+  // The image of a recorded message is not saved, it may never be written.
+  auto logger = LoggerFactory::getLogger("test.recorder.image");
+  testing::internal::CaptureStdout();
+  LOG_DEBUG(logger, "Save to {}", mat);
+  LOG_ERROR(logger, "Error");
+  auto output = testing::internal::GetCapturedStdout();
+  flushImages();
+
+  EXPECT_EQ(output, "Save to Img(not recorded)\nError\n");
+  EXPECT_FALSE(std::filesystem::exists("/tmp/images/test.recorder.image/1"));
+}
+
 }  // namespace
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace cvs::logger;
+
+namespace {
+
+LoggerPtr captureLogger() {
+  LoggerFactory::configure("test.ratelimit",
+                           std::tuple{Level::trace, Sinks::STDOUT, Pattern{"%v"}});
+  return LoggerFactory::getLogger("test.ratelimit");
+}
+
+}  // namespace
+
+TEST(RateLimitTest, every_n) {
+  auto logger = captureLogger();
+
+  testing::internal::CaptureStdout();
+  for (int i = 0; i < 7; ++i)
+    LOG_WARN_EVERY_N(logger, 3, "Test {}", i);
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Test 0\nTest 3 (suppressed 2)\nTest 6 (suppressed 2)\n");
+}
+
+TEST(RateLimitTest, every) {
+  using namespace std::chrono_literals;
+
+  ratelimit::Every every;
+  auto             start = ratelimit::Every::Clock::time_point(1h);
+  std::size_t      suppressed;
+
+  // Calls 0, 10, ... 40 ms after the start with a period of 25 ms.
+  std::vector<std::size_t> passed;
+  for (int i = 0; i < 5; ++i) {
+    if (every.pass(25ms, start + i * 10ms, suppressed))
+      passed.push_back(suppressed);
+  }
+  EXPECT_EQ(passed, (std::vector<std::size_t>{0, 2}));
+
+  // The period counts from the passed call, 30 ms.
+  EXPECT_FALSE(every.pass(25ms, start + 54ms, suppressed));
+  EXPECT_TRUE(every.pass(25ms, start + 55ms, suppressed));
+  EXPECT_EQ(suppressed, 2u);
+}
+
+TEST(RateLimitTest, every_macro) {
+  auto logger = captureLogger();
+
+  testing::internal::CaptureStdout();
+  for (int i = 0; i < 5; ++i)
+    LOG_INFO_EVERY(logger, std::chrono::hours(1), "Test {}", i);
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Test 0\n");
+}
+
+TEST(RateLimitTest, first_n) {
+  auto logger = captureLogger();
+
+  testing::internal::CaptureStdout();
+  for (int i = 0; i < 5; ++i)
+    LOG_ERROR_FIRST_N(logger, 2, "Test {}", i);
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Test 0\nTest 1\n");
+}
+
+TEST(RateLimitTest, concurrent) {
+  LoggerFactory::configure("test.ratelimit.threads", std::tuple{Level::trace, Sinks::NOSINK});
+  auto logger = LoggerFactory::getLogger("test.ratelimit.threads");
+
+  ratelimit::EveryN        every_n;
+  std::atomic_size_t       passed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&] {
+      std::size_t suppressed;
+      for (int i = 0; i < 1000; ++i)
+        if (every_n.pass(10, suppressed))
+          ++passed;
+    });
+  for (auto& t : threads)
+    t.join();
+
+  EXPECT_EQ(passed, 400u);
+}
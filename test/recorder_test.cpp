@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace cvs::logger;
+
+TEST(RecorderTest, dumpOnError) {
+  LoggerFactory::configure("test.recorder", std::tuple{Level::info, Sinks::STDOUT,
+                                                       Pattern{"%l %v"}, Recorder{Level::debug}});
+  auto logger = LoggerFactory::getLogger("test.recorder");
+  EXPECT_TRUE(logger->isEnabled(Level::debug));
+  EXPECT_FALSE(logger->isEnabled(Level::trace));
+
+  testing::internal::CaptureStdout();
+  LOG_DEBUG(logger, "Frame {} took {:.1f} ms", 1, 2.5);
+  LOG_INFO(logger, "Info");
+  LOG_DEBUG(logger, std::string("Runtime {}"), "format");
+  LOG_ERROR(logger, "Error {}", 1);
+  LOG_ERROR(logger, "Error {}", 2);
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output,
+            "info Info\n"
+            "debug Frame 1 took 2.5 ms\n"
+            "debug Runtime format\n"
+            "error Error 1\n"
+            "error Error 2\n");
+}
+
+TEST(RecorderTest, overwrite) {
+  LoggerFactory::configure("test.recorder.ring",
+                           std::tuple{Level::info, Sinks::STDOUT, Pattern{"%v"},
+                                      Recorder{Level::trace, 4, Level::off}});
+  auto logger = LoggerFactory::getLogger("test.recorder.ring");
+
+  testing::internal::CaptureStdout();
+  for (int i = 0; i < 10; ++i)
+    LOG_TRACE(logger, "Trace {} {}", i, std::string(300, 'x').substr(0, i == 9 ? 300 : 1));
+  LOG_ERROR(logger, "Error");
+  logger->dumpRecorder();
+  auto output = testing::internal::GetCapturedStdout();
+
+  // The last message doesn't fit the slot unformatted, so it is truncated.
+  auto last = "Trace 9 " + std::string(300, 'x');
+  last.resize(sizeof(FlightRecorder::Slot::data));
+  EXPECT_EQ(output, "Error\nTrace 6 x\nTrace 7 x\nTrace 8 x\n" + last + "\n");
+}
+
+TEST(RecorderTest, disable) {
+  LoggerFactory::configure("test.recorder.off",
+                           std::tuple{Level::info, Sinks::STDOUT, Pattern{"%v"}, Recorder{}});
+  LoggerFactory::configure("test.recorder.off", std::tuple{Recorder{Level::off}});
+  auto logger = LoggerFactory::getLogger("test.recorder.off");
+  EXPECT_FALSE(logger->isEnabled(Level::debug));
+
+  testing::internal::CaptureStdout();
+  LOG_DEBUG(logger, "Debug");
+  LOG_ERROR(logger, "Error");
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "Error\n");
+}
+
+TEST(RecorderTest, runtime_format) {
+  LoggerFactory::configure("test.recorder.runtime", std::tuple{Level::info, Sinks::STDOUT,
+                                                               Pattern{"%v"}, Recorder{}});
+  auto logger = LoggerFactory::getLogger("test.recorder.runtime");
+
+  // The format text is gone before the ring is dumped.
+  std::string format = "Runtime format {}";
+  testing::internal::CaptureStdout();
+  LOG_DEBUG(logger, fmt::runtime(format), 1);
+  LOG_DEBUG(logger, fmt::runtime(std::string("Temporary runtime format {}")), 2);
+  format = "Overwritten format {}";
+  LOG_ERROR(logger, "Error");
+  auto output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(output, "Runtime format 1\nTemporary runtime format 2\nError\n");
+}
+
+namespace {
+
+// Output of FlightRecorder::dumpAll.
+std::string dumpAll() {
+  auto file = std::tmpfile();
+  FlightRecorder::dumpAll(fileno(file));
+
+  std::string output(std::size_t(std::ftell(file)), '\0');
+  std::rewind(file);
+  output.resize(std::fread(output.data(), 1, output.size(), file));
+  std::fclose(file);
+  return output;
+}
+
+}  // namespace
+
+TEST(RecorderTest, crashDump) {
+  FlightRecorder recorder("test.recorder.dump", Recorder{});
+  recorder.record(Level::debug, "Raw {} {:.1f} {} {{{}}} {}", 3, 2.5, "text", 'c', true);
+  recorder.recordFormatted(Level::info, "Formatted {:>3}", 7);
+
+  auto output = dumpAll();
+  EXPECT_NE(output.find("] [test.recorder.dump] [debug] Raw 3 2.5 text {c} true\n"),
+            std::string::npos)
+      << output;
+  EXPECT_NE(output.find("] [test.recorder.dump] [info] Formatted   7\n"), std::string::npos)
+      << output;
+
+  // A replaced recorder leaves the crash dump.
+  recorder.retire();
+  EXPECT_EQ(dumpAll().find("test.recorder.dump"), std::string::npos);
+}
+
+TEST(RecorderTest, registryFull) {
+  auto before = FlightRecorder::unregistered();
+  {
+    std::vector<std::unique_ptr<FlightRecorder>> recorders;
+    for (int i = 0; i < 70; ++i)
+      recorders.push_back(std::make_unique<FlightRecorder>("test.recorder.full", Recorder{}));
+
+    EXPECT_GE(FlightRecorder::unregistered(), before + 6);
+    EXPECT_NE(dumpAll().find("flight recorders were not dumped"), std::string::npos);
+  }
+  EXPECT_EQ(FlightRecorder::unregistered(), before);
+}
+
+TEST(RecorderDeathTest, crash) {
+  EXPECT_DEATH(
+      {
+        LoggerFactory::configure("test.recorder.crash",
+                                 std::tuple{Level::info, Sinks::NOSINK,
+                                            Recorder{Level::trace, 16, Level::err, true}});
+        auto logger = LoggerFactory::getLogger("test.recorder.crash");
+        LOG_TRACE(logger, "Step {} of {}", 3, 5);
+        std::abort();
+      },
+      "\\[test.recorder.crash\\] \\[trace\\] Step 3 of 5");
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <cvs/logger/logging.hpp>
+#include <cvs/logger/tools/stagetracker.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace cvs::logger;
+using namespace std::chrono_literals;
+
+TEST(StageTrackerTest, nested) {
+  LoggerFactory::configure("test.stages", std::tuple{Level::info, Sinks::NOSINK});
+  tools::StageTracker tracker("test.stages");
+  tracker.setFrameBudget(10ms);
+
+  for (int i = 0; i < 3; ++i) {
+    STAGE_TIMER(tracker, "frame");
+    {
+      STAGE_TIMER(tracker, "detect");
+      std::this_thread::sleep_for(2ms);
+    }
+    tracker.record(tracker.stage("track"), 1ms);
+  }
+
+  auto stats = tracker.getStat();
+  ASSERT_EQ(stats.size(), 3u);
+  EXPECT_EQ(stats[0].path, "frame");
+  EXPECT_EQ(stats[1].path, "frame/detect");
+  EXPECT_EQ(stats[2].path, "track");
+  EXPECT_EQ(stats[1].count, 3u);
+  EXPECT_GE(stats[1].p50, 2ms);
+  EXPECT_GE(stats[0].mean, stats[1].mean);
+  EXPECT_EQ(stats[2].mean, 1ms);
+  EXPECT_DOUBLE_EQ(stats[2].share, 0.1);
+
+  tracker.report();
+  EXPECT_EQ(tracker.getStat()[0].count, 0u);
+}
+
+TEST(StageTrackerTest, threads) {
+  LoggerFactory::configure("test.stages.threads",
+                           std::tuple{Level::debug, Sinks::STDOUT, Pattern{"%v"}});
+
+  testing::internal::CaptureStdout();
+  {
+    tools::StageTracker tracker("test.stages.threads");
+    tracker.setReportDuration(1ms);
+    auto stage = tracker.stage("work");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+      threads.emplace_back([&tracker, stage] {
+        for (int i = 0; i < 1000; ++i)
+          tracker.record(stage, std::chrono::microseconds(i));
+      });
+    for (auto& t : threads)
+      t.join();
+
+    // Periodic reports took some of the records, the final one takes the rest.
+    tracker.setAutoreport(false);
+    tracker.report();
+    EXPECT_EQ(tracker.getStat()[0].count, 0u);
+  }
+  auto output = testing::internal::GetCapturedStdout();
+
+  std::uint64_t      reported = 0;
+  std::istringstream lines(output);
+  for (std::string line; std::getline(lines, line);) {
+    if (line.rfind("Stage work: ", 0) == 0)
+      reported += std::stoull(line.substr(12));
+  }
+  EXPECT_EQ(reported, 4000u) << output;
+}
+
+TEST(StageTrackerTest, exited_threads) {
+  LoggerFactory::configure("test.stages.exited", std::tuple{Level::info, Sinks::NOSINK});
+  tools::StageTracker tracker("test.stages.exited");
+  auto                stage = tracker.stage("work");
+
+  // The records of exited threads are kept after their data is freed.
+  for (int t = 0; t < 64; ++t)
+    std::thread([&tracker, stage, t] { tracker.record(stage, std::chrono::milliseconds(t)); })
+        .join();
+
+  auto stats = tracker.getStat();
+  ASSERT_EQ(stats.size(), 1u);
+  EXPECT_EQ(stats[0].count, 64u);
+  EXPECT_EQ(stats[0].max, 63ms);
+  EXPECT_EQ(stats[0].mean, std::chrono::microseconds(31500));
+
+  tracker.report();
+  EXPECT_EQ(tracker.getStat()[0].count, 0u);
+}
+
+TEST(StageTrackerTest, call_site) {
+  LoggerFactory::configure("test.stages.site", std::tuple{Level::info, Sinks::NOSINK});
+  tools::StageTracker tracker0("test.stages.site");
+  tools::StageTracker tracker1("test.stages.site");
+  tracker1.stage("other");
+
+  // The id cached by the call site belongs to the tracker it was taken from.
+  auto work = [](tools::StageTracker& tracker) { STAGE_TIMER(tracker, "work"); };
+  work(tracker0);
+  work(tracker1);
+  work(tracker1);
+
+  ASSERT_EQ(tracker0.getStat().size(), 1u);
+  EXPECT_EQ(tracker0.getStat()[0].count, 1u);
+  auto stats = tracker1.getStat();
+  ASSERT_EQ(stats.size(), 2u);
+  EXPECT_EQ(stats[0].path, "other");
+  EXPECT_EQ(stats[0].count, 0u);
+  EXPECT_EQ(stats[1].path, "work");
+  EXPECT_EQ(stats[1].count, 2u);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+// Every level below info is stripped in this translation unit.
+#undef CVSLOGGER_ACTIVE_LEVEL
+#define CVSLOGGER_ACTIVE_LEVEL 2
+#include <cvs/logger/logging.hpp>
+
+#include <tuple>
+
+using namespace cvs::logger;
+
+namespace {
+
+int evaluated = 0;
+
+int evaluate() { return ++evaluated; }
+
+TEST(StripTest, active_level) {
+  LoggerFactory::configure("test.strip", std::tuple{Level::trace, Sinks::NOSINK});
+  auto logger = LoggerFactory::getLogger("test.strip");
+
+  LOG_TRACE(logger, "{}", evaluate());
+  LOG_DEBUG(logger, "{}", evaluate());
+  LOG_NAMED_TRACE("test.strip", "{}", evaluate());
+  LOG_GLOB_DEBUG("{}", evaluate());
+  EXPECT_EQ(evaluated, 0);
+
+  LOG_INFO(logger, "{}", evaluate());
+  LOG_NAMED_WARN("test.strip", "{}", evaluate());
+  LOG_ERROR(logger, "{}", evaluate());
+  EXPECT_EQ(evaluated, 3);
+}
+
+}  // namespace
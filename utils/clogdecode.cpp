@@ -0,0 +1,60 @@
+#include "../src/deferredbackend.hpp"
+
+#include <fmt/format.h>
+
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using cvs::logger::DeferredBackend;
+
+namespace {
+
+constexpr const char* level_names[] = {"trace", "debug", "info", "warning", "error", "critical"};
+
+std::string formatTime(std::int64_t timestamp) {
+  std::time_t seconds = timestamp / 1000000000;
+  std::tm     tm;
+  localtime_r(&seconds, &tm);
+
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+  return fmt::format("{}.{:03}", buffer, timestamp / 1000000 % 1000);
+}
+
+}  // namespace
+
+/**
+ * Prints a binary log written by Backend::binary in the default spdlog layout.
+ *
+ * Usage: cvslogger_decode <file.clog>
+ */
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file.clog>" << std::endl;
+    return 1;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file) {
+    std::cerr << "Can't open " << argv[1] << std::endl;
+    return 1;
+  }
+  std::string log(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>{});
+
+  try {
+    DeferredBackend::decode(log, [](const DeferredBackend::Message& m) {
+      auto level = std::size_t(m.level);
+      std::cout << fmt::format("[{}] [{}] [{}] {}\n", formatTime(m.timestamp), m.logger,
+                               level < std::size(level_names) ? level_names[level] : "?", m.text);
+    });
+  }
+  catch (const std::exception& e) {
+    std::cerr << argv[1] << ": " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include "../src/framering.hpp"
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using cvs::logger::FrameRing;
+
+namespace {
+
+/**
+ * Collects the complete records of a ring file. Torn or overwritten records are skipped by
+ * resynchronising on the record alignment.
+ */
+std::vector<const FrameRing::FrameRecord*> readRecords(const unsigned char* base,
+                                                       std::size_t          file_size) {
+  std::vector<const FrameRing::FrameRecord*> records;
+
+  auto header = reinterpret_cast<const FrameRing::FileHeader*>(base);
+  if (file_size < FrameRing::data_offset || header->magic != FrameRing::file_magic ||
+      header->capacity > file_size - FrameRing::data_offset)
+    return records;
+
+  const auto    data = base + FrameRing::data_offset;
+  std::uint64_t pos  = 0;
+  while (pos + sizeof(FrameRing::FrameRecord) <= header->capacity) {
+    auto record = reinterpret_cast<const FrameRing::FrameRecord*>(data + pos);
+    auto valid  = record->size >= sizeof(FrameRing::FrameRecord) &&
+                 record->size % FrameRing::alignment == 0 && pos + record->size <= header->capacity;
+
+    auto pixels = sizeof(FrameRing::FrameRecord) + record->step * std::uint64_t(record->rows);
+    if (valid && record->magic == FrameRing::record_magic && record->rows > 0 && record->cols > 0 &&
+        pixels <= record->size) {
+      records.push_back(record);
+      pos += record->size;
+    } else if (valid && record->magic == FrameRing::skip_magic)
+      pos += record->size;
+    else
+      pos += FrameRing::alignment;
+  }
+
+  std::sort(records.begin(), records.end(),
+            [](auto r0, auto r1) { return r0->seq < r1->seq; });
+  return records;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <ring file> <output dir> [record offset]" << std::endl;
+    return 1;
+  }
+
+  std::filesystem::path out_dir = argv[2];
+  long long             offset  = argc > 3 ? std::stoll(argv[3]) : -1;
+
+  int fd = ::open(argv[1], O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    std::cerr << "Can't open " << argv[1] << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  struct stat st {};
+  ::fstat(fd, &st);
+  auto  file_size = std::size_t(st.st_size);
+  void* addr      = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    std::cerr << "Can't map " << argv[1] << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  const auto base    = static_cast<const unsigned char*>(addr);
+  auto       records = readRecords(base, file_size);
+
+  std::filesystem::create_directories(out_dir);
+  std::size_t saved = 0;
+  for (auto record : records) {
+    auto record_offset = reinterpret_cast<const unsigned char*>(record) - base;
+    if (offset >= 0 && record_offset != offset)
+      continue;
+
+    // The record is read-only mapped memory, the Mat header only refers to it.
+    cv::Mat frame(record->rows, record->cols, record->type,
+                  const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(record + 1)),
+                  record->step);
+
+    auto file = out_dir / (std::to_string(record->seq) + "_" + std::to_string(record->level) + "_" +
+                           std::to_string(record->timestamp) + ".png");
+    if (cv::imwrite(file.string(), frame))
+      ++saved;
+    else
+      std::cerr << "Can't write " << file << std::endl;
+  }
+
+  ::munmap(addr, file_size);
+
+  std::cout << saved << " of " << records.size() << " frames extracted to " << out_dir << std::endl;
+  return 0;
+}
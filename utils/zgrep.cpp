@@ -0,0 +1,96 @@
+#include <zlib.h>
+
+#include <iostream>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t chunk_size = std::size_t(256) << 10;
+
+/**
+ * Prints the lines of `file` that match `re`. zlib reads plain files transparently, so active
+ * segments and compressed ones are searched alike, without unpacking them to disk.
+ */
+bool grepFile(const char* file, const std::regex& re, bool print_name, std::size_t& matches) {
+  gzFile in = gzopen(file, "rb");
+  if (!in) {
+    std::cerr << "Can't open " << file << std::endl;
+    return false;
+  }
+  gzbuffer(in, chunk_size);
+
+  std::vector<char> chunk(chunk_size);
+  std::string       line;
+  auto              process = [&] {
+    if (std::regex_search(line, re)) {
+      if (print_name)
+        std::cout << file << ':';
+      std::cout << line << '\n';
+      ++matches;
+    }
+    line.clear();
+  };
+
+  int read;
+  while ((read = gzread(in, chunk.data(), unsigned(chunk.size()))) > 0) {
+    std::string_view data(chunk.data(), std::size_t(read));
+    for (auto pos = data.find('\n'); pos != std::string_view::npos; pos = data.find('\n')) {
+      line.append(data.substr(0, pos));
+      process();
+      data.remove_prefix(pos + 1);
+    }
+    line.append(data);
+  }
+  if (!line.empty())
+    process();
+
+  if (read < 0) {
+    int err;
+    std::cerr << file << ": " << gzerror(in, &err) << std::endl;
+  }
+  gzclose(in);
+  return read == 0;
+}
+
+}  // namespace
+
+/**
+ * Streaming grep over plain and gzip-compressed log segments.
+ *
+ * Usage: cvslogger_zgrep [-i] <regex> <file>...
+ */
+int main(int argc, char** argv) {
+  int  arg   = 1;
+  auto flags = std::regex::ECMAScript | std::regex::optimize;
+  if (arg < argc && std::string_view(argv[arg]) == "-i") {
+    flags |= std::regex::icase;
+    ++arg;
+  }
+  if (argc - arg < 2) {
+    std::cerr << "Usage: " << argv[0] << " [-i] <regex> <file>..." << std::endl;
+    return 2;
+  }
+
+  std::regex re;
+  try {
+    re = std::regex(argv[arg++], flags);
+  }
+  catch (const std::regex_error& e) {
+    std::cerr << "Invalid regex: " << e.what() << std::endl;
+    return 2;
+  }
+
+  bool        ok         = true;
+  bool        print_name = argc - arg > 1;
+  std::size_t matches    = 0;
+  for (; arg < argc; ++arg)
+    ok = grepFile(argv[arg], re, print_name, matches) && ok;
+
+  // The exit codes of grep: 0 on a match, 1 without, 2 on errors.
+  if (!ok)
+    return 2;
+  return matches > 0 ? 0 : 1;
+}